@@ -8,6 +8,19 @@
  * the release IResponse. This envelope generator is also an
  * IKeyEventListener, which allows it to accept RELEASED key events to trigger
  * the release stage.
+ *
+ * The responses are held by value and called on their own type, so with a
+ * final Response type the compiler calls them directly and can inline them
+ * into the render loop. Each stage gets its own copy, so a Response needs to
+ * own everything it uses for the stages' slopes to stay independent. To
+ * switch responses at runtime, use a SelectableResponse and change the ones
+ * returned by the getters.
+ *
+ * render fills a whole block at once. Each stage is entered with one exact
+ * call to its response, and after that the output is stepped with a multiply
+ * and an add per sample, so the responses are only evaluated at the start of
+ * each stage in the block instead of on every sample. Responses that can't be
+ * stepped this way are still called for each sample.
 *******************************************************************************/
 
 #include "IEnvelopeGenerator.hpp"
@@ -25,19 +38,24 @@ class ADSREnvelopeGenerator : public IEnvelopeGenerator
 {
 	public:
 		ADSREnvelopeGenerator (const float atkSec, const float decSec, const float susLVL, const float relSec,
-					Response* atkResponse, Response* decResponse, Response* relResponse);
+					const Response& atkResponse = Response(), const Response& decResponse = Response(),
+					const Response& relResponse = Response());
 		~ADSREnvelopeGenerator() override;
 
 		float nextValue() override;
+		void render (float* out, unsigned int numValues) override;
 		float currentValue() override;
 		void toStart() override;
 		void toEnd() override;
 
 		void onKeyEvent (const KeyEvent& keyEvent) override;
 
-		void setAttackResponse (Response* response);
-		void setDecayResponse (Response* response);
-		void setReleaseResponse (Response* response);
+		void setAttackResponse (const Response& response);
+		void setDecayResponse (const Response& response);
+		void setReleaseResponse (const Response& response);
+		Response& getAttackResponse() { return m_AttackResponse; }
+		Response& getDecayResponse() { return m_DecayResponse; }
+		Response& getReleaseResponse() { return m_ReleaseResponse; }
 		void setAttack (float seconds, float expo);
 		void setDecay (float seconds, float expo);
 		void setSustain (float lvl);
@@ -65,9 +83,11 @@ class ADSREnvelopeGenerator : public IEnvelopeGenerator
 		float m_CurrentLvl;
 		bool  m_JustEnteredRelease; // used to signal when to set release (since can happen at any lvl)
 
-		Response* m_AttackResponse;
-		Response* m_DecayResponse;
-		Response* m_ReleaseResponse;
+		Response m_AttackResponse;
+		Response m_DecayResponse;
+		Response m_ReleaseResponse;
+
+		template <unsigned int stage> inline bool renderStage (float* out, unsigned int numValues, unsigned int& value);
 };
 
 #endif // ADSRENVELOPEGENERATOR_HPP
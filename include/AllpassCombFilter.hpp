@@ -34,9 +34,12 @@ class AllpassCombFilter : public IBufferCallback<T>
 		void setDelayLength (unsigned int delayLength); // must be less than or equal to initially defined delay length
 		void setFeedbackGain (float feedbackGain);
 
-		void call (T* writeBuffer) override;
+		using IBufferCallback<T>::call;
+		void process (T* writeBuffer, unsigned int numSamples) override;
 		// modSource should be an array of ABUFFER_SIZE floats between 0.0f and 1.0f that modulates delay length by numModSamples
 		void call (T* writeBuffer, unsigned int numModSamples, float* modSource); // numModSamples must be less than or equal to delayLength
+		// same as above, but modSource should be an array of numSamples floats
+		void process (T* writeBuffer, unsigned int numSamples, unsigned int numModSamples, float* modSource);
 
 	private:
 		unsigned int 	m_DelayLength;
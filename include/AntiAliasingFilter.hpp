@@ -3,36 +3,161 @@
 
 /*******************************************************************************
  * A simple anti-aliasing filter implemented by a low-pass FIR filter with a
- * sinc function windowed by a hamming window. FIR filter is used for linear
- * phase properties.
+ * windowed sinc function. The window defaults to a hamming window, but a
+ * blackman-harris or kaiser window (with an adjustable beta) can be used for
+ * more stopband attenuation. FIR filter is used for linear phase properties.
+ * Where latency matters more than phase (live monitoring), the filter can
+ * instead be designed as the minimum phase filter with the same magnitude
+ * response, which moves most of the group delay out of the passband.
+ * getLatencySamples reports the group delay of the active design at DC.
  *
  * Note: Since this filter is mostly intended to be used in resampling sources
  * both inside and outside of this library, it is not implemented as an
  * IBufferCallback. Instead, components such as SampleRateConverter use it as
  * a utility.
+ *
+ * Besides filtering a buffer in place at its own rate, the filter can be used
+ * as a polyphase resampler by integer or rational factors. In that case the
+ * filter should be designed at the upsampled rate (input rate * upFactor),
+ * and only the outputs that are kept are computed, each using only the taps
+ * of its polyphase branch.
+ *
+ * The working buffer stores every sample twice (a mirrored delay line) so the
+ * history is always contiguous, which lets the convolution run through the
+ * SIMD kernels in FIRKernels.
+ *
+ * Coefficients are kept in a process-wide cache keyed on the cutoff, sample
+ * rate, order and window, so filters with the same design (for example when
+ * switching back and forth between host sample rates) don't need to recompute
+ * them. cacheCoefficients adds a design to the cache and should be called off
+ * the audio thread; changeValues only ever reads from it. Minimum phase designs
+ * allocate while they're calculated, so they should always be cached first.
+ *
+ * changeValues is safe to call from the audio thread every block. The new
+ * coefficients are written into a second coefficient set and the output is
+ * crossfaded from the old set to the new one over a short number of samples,
+ * while the history is kept. No memory is allocated as long as the filter order
+ * doesn't exceed the largest order the filter has been given (see reserve),
+ * apart from the polyphase tables resample builds the first time it sees an up
+ * factor.
+ * If changeValues is called again before a crossfade finishes, what's being
+ * heard is a mix of both sets. Since they filter the same history, that mix
+ * is a filter too, so it's baked into one set and the crossfade to the new
+ * design starts from it. Nothing that's being heard is dropped, so calling
+ * changeValues every block doesn't click however short the blocks are.
 *******************************************************************************/
 
+#include <memory>
 #include <vector>
 
+enum class FilterWindow : unsigned int
+{
+	HAMMING,
+	BLACKMAN_HARRIS,
+	KAISER
+};
+
+enum class FilterPhase : unsigned int
+{
+	LINEAR,
+	MINIMUM
+};
+
+constexpr float DEFAULT_KAISER_BETA = 8.6f; // roughly 86dB of stopband attenuation
+
+// position runs from 0 to 1 across the window, so other windowed designs can share the same windows
+float calculateFilterWindow (const FilterWindow window, const float kaiserBeta, const float position);
+constexpr unsigned int DEFAULT_AAF_CROSSFADE_LENGTH = 64;
+
 template <typename T>
 class AntiAliasingFilter
 {
 	public:
-		AntiAliasingFilter (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder);
+		// kaiserBeta is only used by the kaiser window
+		AntiAliasingFilter (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+					const FilterWindow window = FilterWindow::HAMMING, const float kaiserBeta = DEFAULT_KAISER_BETA,
+					const FilterPhase phase = FilterPhase::LINEAR);
+
+		// stride lets one filter per channel run over an interleaved buffer
+		void call (T* const buffer, const unsigned int bufferSize, const unsigned int stride = 1);
+
+		// returns the number of samples written to outBuffer, which needs room for
+		// ( (inBufferSize * upFactor) / downFactor ) + 1 samples
+		unsigned int resample (const T* const inBuffer, const unsigned int inBufferSize, T* const outBuffer,
+					const unsigned int upFactor, const unsigned int downFactor);
+		// in place, returns the number of samples written to the start of buffer
+		unsigned int decimate (T* const buffer, const unsigned int bufferSize, const unsigned int factor);
+		// outBuffer needs room for inBufferSize * factor samples
+		void interpolate (const T* const inBuffer, const unsigned int inBufferSize, T* const outBuffer, const unsigned int factor);
 
-		void call (T* const buffer, const unsigned int bufferSize);
+		void changeValues (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+					const FilterWindow window = FilterWindow::HAMMING, const float kaiserBeta = DEFAULT_KAISER_BETA,
+					const FilterPhase phase = FilterPhase::LINEAR);
+		// allocates room for filter orders up to maxFilterOrder so that changeValues never has to, keeping the history
+		void reserve (const unsigned int maxFilterOrder);
 
-		void changeValues (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder);
+		// in samples (or output samples when resampling), 0 switches coefficients immediately
+		void setCrossfadeLength (const unsigned int crossfadeLength)
+		{
+			m_CrossfadeLength = crossfadeLength;
+			m_CrossfadeSamplesLeft = ( m_CrossfadeSamplesLeft > crossfadeLength ) ? crossfadeLength : m_CrossfadeSamplesLeft;
+		}
+		unsigned int getCrossfadeLength() const { return m_CrossfadeLength; }
+		bool isCrossfading() const { return m_CrossfadeSamplesLeft > 0; }
+
+		unsigned int getFilterOrder() const { return m_FilterOrder; }
+		unsigned int getMaxFilterOrder() const { return m_MaxFilterOrder; }
+		FilterWindow getWindow() const { return m_Window; }
+		float getKaiserBeta() const { return m_KaiserBeta; }
+		FilterPhase getPhase() const { return m_Phase; }
+		// the group delay of the newest coefficient set at DC, in samples at the filter's sample rate
+		float getLatencySamples() const { return m_GroupDelay[m_ActiveCoefficients]; }
+
+		static void cacheCoefficients (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+						const FilterWindow window = FilterWindow::HAMMING, const float kaiserBeta = DEFAULT_KAISER_BETA,
+						const FilterPhase phase = FilterPhase::LINEAR);
+		static void clearCoefficientCache();
+		static unsigned int getCoefficientCacheSize();
 
 	private:
 		float 			m_CutoffFreq;
 		unsigned int 		m_SampleRate;
 		unsigned int 		m_FilterOrder;
-		std::vector<float> 	m_Coefficients;
-		std::vector<float> 	m_WorkingBuffer; 	// this is a circular buffer that the input buffer of call is copied into
-		unsigned int 		m_WorkingBufferIncr;
+		unsigned int 		m_MaxFilterOrder; 	// the length of the history, filters of any order up to this share it
+		FilterWindow 		m_Window;
+		float 			m_KaiserBeta;
+		FilterPhase 		m_Phase;
+		std::vector<float> 	m_Coefficients[2]; 	// double-buffered so the old set can be crossfaded out
+		float 			m_GroupDelay[2]; 	// of each coefficient set
+		unsigned int 		m_ActiveCoefficients; 	// index of the newest coefficient set
+		unsigned int 		m_CrossfadeLength;
+		unsigned int 		m_CrossfadeSamplesLeft;
+		std::vector<float> 	m_WorkingBuffer; 	// this is a mirrored circular buffer that the input buffer of call is copied into
+		unsigned int 		m_WorkingBufferIncr; 	// index of the newest sample, older samples follow it
+		unsigned int 		m_PolyphaseIndex; 	// upsampled-rate position of the next output relative to the newest input
+		std::vector<float> 	m_PolyphaseCoefficients[2]; // coefficients rearranged so each polyphase branch is contiguous
+		unsigned int 		m_PolyphaseUpFactor[2]; // the up factor each polyphase set was arranged for, 0 if none
+		unsigned int 		m_PolyphaseBranchLength[2];
+
+		void setCoefficients (const unsigned int set);
+		// while crossfading, replaces the newest coefficient set with the mix of both sets that's currently being heard
+		void bakeCrossfade();
+
+		inline void pushSample (const float sampleVal)
+		{
+			m_WorkingBufferIncr = ( m_WorkingBufferIncr == 0 ) ? m_MaxFilterOrder - 1 : m_WorkingBufferIncr - 1;
+			m_WorkingBuffer[m_WorkingBufferIncr] = sampleVal;
+			m_WorkingBuffer[m_WorkingBufferIncr + m_MaxFilterOrder] = sampleVal;
+		}
+		// mixes the output of the old coefficient set into the output of the new one while crossfading
+		inline float crossfade (const float newOutput, const float oldOutput)
+		{
+			m_CrossfadeSamplesLeft--;
+			const float newGain = 1.0f - ( static_cast<float>(m_CrossfadeSamplesLeft) / static_cast<float>(m_CrossfadeLength) );
 
-		std::vector<float> calculateCoefficients();
+			return oldOutput + ( (newOutput - oldOutput) * newGain );
+		}
+		const float* getPolyphaseCoefficients (const unsigned int set, const unsigned int upFactor);
 
 		T getZeroPoint();
 };
@@ -2,19 +2,37 @@
 #define AUDIOBUFFER_HPP
 
 /******************************************************************
- * A generic audio buffer which contains two arrays that allow
- * for IBufferCallbacks to write to a "write buffer" while outputs
- * read from a "read buffer". This ensures that reading and
+ * A generic audio buffer which contains two or more blocks that
+ * allow for IBufferCallbacks to write to "write blocks" while
+ * outputs read from a "read block". This ensures that reading and
  * writing are performed on separate memory blocks. This class
- * manages the switching between buffers as well as allows for
+ * manages the switching between blocks as well as allows for
  * the registering of IBufferCallbacks, which write to the write
- * buffer.
+ * blocks. IBufferCallbacks are called in the order they appear in
+ * the callback chain.
+ *
+ * The number of samples per buffer defaults to ABUFFER_SIZE, but
+ * can be set at runtime for hosts with differing block sizes.
+ *
+ * More than two blocks can be used, in which case the buffer acts
+ * as a lock-free single-producer/single-consumer ring. The reading
+ * side (getNextSample) may run on an ISR or audio thread while the
+ * writing side (pollToFillBuffers) runs on a worker thread, which
+ * can then render ahead by up to numBlocks - 1 blocks. All other
+ * functions should only be called while neither side is running.
+ *
+ * getBlock and getNextBlockToWrite work with any number of blocks.
+ * triggerCallbacksOnNextPoll, buffer1IsNextToWrite and the
+ * getBuffer1/getBuffer2 style accessors are from when there were
+ * only ever two blocks, and only mean what their names say when
+ * numBlocks is 2.
 ******************************************************************/
 
 #include "IBufferCallback.hpp"
+#include "BlockRing.hpp"
 
 #include "AudioConstants.hpp"
-#include <set>
+#include <vector>
 #include <stdint.h>
 
 template <typename T=float, bool isStereo=false>
@@ -24,34 +42,68 @@ template <typename T>
 class AudioBuffer<T, false>
 {
 	public:
-		AudioBuffer();
+		AudioBuffer (unsigned int numSamples = ABUFFER_SIZE, unsigned int numBlocks = 2);
 		AudioBuffer (const AudioBuffer& other);
 		virtual ~AudioBuffer();
 
 		AudioBuffer<T, false>& operator= (const AudioBuffer<T, false>& other);
 
 		unsigned int getNumSamples() const;
+		void setNumSamples (unsigned int numSamples); // reallocates the buffers, so don't call from the audio thread
+		unsigned int getNumBlocks() const;
+		void setNumBlocks (unsigned int numBlocks); // must be at least 2, reallocates the buffers like setNumSamples
 		T getNextSample (T sampleValToReadBuf = 0); 	// if we're also reading data (from ADC for example)
 								// we write those samples back into the 'read' buffer
+		// same as above, but copies numSamples samples (which may cross blocks) to dst in bulk, writing back zeros if
+		// sampleValsToReadBuf is null, sampleValsToReadBuf may be the same as dst but may not otherwise overlap it
+		void readBlock (T* dst, unsigned int numSamples, const T* sampleValsToReadBuf = nullptr);
 
 		void triggerCallbacksOnNextPoll (bool writeToBuffer1); // if not writing to buffer 1, writing to buffer 2
-		void pollToFillBuffers();
-
+		void pollToFillBuffers(); // fills every block the reading side has finished with
+		// same as above, but calls the given callbacks in order without virtual dispatch instead of the callback chain
+		template <typename... Callbacks>
+		void pollToFillBuffers (Callbacks&... callbacks)
+		{
+			this->fillFreeBlocks( [&callbacks...] (T* writeBuffer, unsigned int numSamples)
+						{ ( callbacks.Callbacks::process(writeBuffer, numSamples), ... ); } );
+		}
+
+		unsigned int getNextBlockToWrite() const; // the block the next poll fills first, once the reading side is done with it
+		const T* getBlock (unsigned int block) const; // block runs from 0 to numBlocks - 1
+
+		// two block only, see above
 		bool buffer1IsNextToWrite() const; // if buffer 1 is not next to write, buffer 2 is next to write
-
 		const T* getBuffer1() const;
 		const T* getBuffer2() const;
 
-		const std::set<IBufferCallback<T, false>*>& getCallbacks() const;
-		void registerCallback (IBufferCallback<T, false>* callback);
+		const std::vector<IBufferCallback<T, false>*>& getCallbacks() const;
+		void registerCallback (IBufferCallback<T, false>* callback); // appends to the end of the callback chain
+		void registerCallback (IBufferCallback<T, false>* callback, unsigned int position); // inserts before the given position
+		void unregisterCallback (IBufferCallback<T, false>* callback);
 
 	private:
-		T 		m_Buffers[ABUFFER_SIZE * 2];
+		unsigned int 	m_NumSamples;
+		unsigned int 	m_NumBlocks;
+		T* 		m_Buffers;
+
+		BlockRing<1> 	m_Ring;
+
+		// read side
 		T* 		m_CurrentBuffer;
 		unsigned int 	m_Pos;
-		std::set<IBufferCallback<T, false>*> m_Callbacks;
 
-		bool m_NextReadBlockFilled;
+		// write side
+		std::vector<IBufferCallback<T, false>*> 	m_Callbacks;
+
+		void allocateBuffers (unsigned int numSamples, unsigned int numBlocks);
+		void resetCounts();
+		void advanceReadBlock();
+
+		template <typename Fill>
+		void fillFreeBlocks (const Fill& fill)
+		{
+			m_Ring.fillFreeBlocks( [this, &fill] (unsigned int block) { fill(&m_Buffers[block * m_NumSamples], m_NumSamples); } );
+		}
 
 		T* getBuffer(bool writeBuffer);
 };
@@ -60,40 +112,80 @@ template <typename T>
 class AudioBuffer<T, true>
 {
 	public:
-		AudioBuffer();
+		AudioBuffer (unsigned int numSamples = ABUFFER_SIZE, unsigned int numBlocks = 2);
 		AudioBuffer (const AudioBuffer& other);
 		virtual ~AudioBuffer();
 
 		AudioBuffer<T, true>& operator= (const AudioBuffer<T, true>& other);
 
 		unsigned int getNumSamples() const;
+		void setNumSamples (unsigned int numSamples); // reallocates the buffers, so don't call from the audio thread
+		unsigned int getNumBlocks() const;
+		void setNumBlocks (unsigned int numBlocks); // must be at least 2, reallocates the buffers like setNumSamples
 		T getNextSampleL (T sampleValToReadBuf = 0);
 		T getNextSampleR (T sampleValToReadBuf = 0);
+		// same as above, but copies numSamples samples for each channel in bulk (see the mono readBlock)
+		void readBlock (T* dstL, T* dstR, unsigned int numSamples,
+				const T* sampleValsToReadBufL = nullptr, const T* sampleValsToReadBufR = nullptr);
 
 		void triggerCallbacksOnNextPoll (bool writeToBuffer1);
-		void pollToFillBuffers();
-
+		void pollToFillBuffers(); // fills every block both the left and right reading sides have finished with
+		// same as above, but calls the given callbacks in order without virtual dispatch instead of the callback chain
+		template <typename... Callbacks>
+		void pollToFillBuffers (Callbacks&... callbacks)
+		{
+			this->fillFreeBlocks( [&callbacks...] (T* writeBufferL, T* writeBufferR, unsigned int numSamples)
+						{ ( callbacks.Callbacks::process(writeBufferL, writeBufferR, numSamples), ... ); } );
+		}
+
+		unsigned int getNextBlockToWrite() const; // the block the next poll fills first, once the reading sides are done with it
+		const T* getBlockL (unsigned int block) const; // block runs from 0 to numBlocks - 1
+		const T* getBlockR (unsigned int block) const;
+
+		// two block only, see above
 		bool buffer1IsNextToWrite() const;
-
 		const T* getBufferL1() const;
 		const T* getBufferL2() const;
 		const T* getBufferR1() const;
 		const T* getBufferR2() const;
 
-		const std::set<IBufferCallback<T, true>*>& getCallbacks() const;
-		void registerCallback (IBufferCallback<T, true>* callback);
+		const std::vector<IBufferCallback<T, true>*>& getCallbacks() const;
+		void registerCallback (IBufferCallback<T, true>* callback); // appends to the end of the callback chain
+		void registerCallback (IBufferCallback<T, true>* callback, unsigned int position); // inserts before the given position
+		void unregisterCallback (IBufferCallback<T, true>* callback);
 
 	private:
-		T 		m_BuffersL[ABUFFER_SIZE * 2];
-		T 		m_BuffersR[ABUFFER_SIZE * 2];
+		unsigned int 	m_NumSamples;
+		unsigned int 	m_NumBlocks;
+		T* 		m_BuffersL;
+		T* 		m_BuffersR;
+
+		BlockRing<2> 	m_Ring; // the left and right channels are read separately
+
+		// read side
 		T* 		m_CurrentBufferL;
 		T* 		m_CurrentBufferR;
 		unsigned int 	m_PosL;
 		unsigned int 	m_PosR;
-		std::set<IBufferCallback<T, true>*> m_Callbacks;
 
-		bool m_NextReadBlockFilledL;
-		bool m_NextReadBlockFilledR;
+		// write side
+		std::vector<IBufferCallback<T, true>*> 	m_Callbacks;
+
+		void allocateBuffers (unsigned int numSamples, unsigned int numBlocks);
+		void resetCounts();
+		void advanceReadBlock (T*& currentBuffer, unsigned int reader, T* buffers);
+		void readChannelBlock (T* dst, unsigned int numSamples, const T* sampleValsToReadBuf,
+					T*& currentBuffer, unsigned int& pos, unsigned int reader, T* buffers);
+
+		template <typename Fill>
+		void fillFreeBlocks (const Fill& fill)
+		{
+			m_Ring.fillFreeBlocks( [this, &fill] (unsigned int block)
+						{
+							const unsigned int blockOffset = block * m_NumSamples;
+							fill( &m_BuffersL[blockOffset], &m_BuffersR[blockOffset], m_NumSamples );
+						} );
+		}
 
 		T* getBufferL(bool writeBuffer);
 		T* getBufferR(bool writeBuffer);
@@ -14,6 +14,9 @@
 #ifndef ABUFFER_SIZE
 #define ABUFFER_SIZE 256
 #endif // ABUFFER_SIZE
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif // CACHE_LINE_SIZE
 
 // Musical Frequencies
 #define MUSIC_G9  12543.85
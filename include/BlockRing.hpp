@@ -0,0 +1,162 @@
+#ifndef BLOCKRING_HPP
+#define BLOCKRING_HPP
+
+/******************************************************************
+ * A BlockRing keeps track of which blocks of a buffer are filled
+ * and which are free, for buffers like the AudioBuffer and the
+ * MultiChannelAudioBuffer that are read on one thread and written
+ * on another. It only deals in block indices, so the buffer it
+ * belongs to keeps the samples and how they're laid out.
+ *
+ * It's a lock-free single-producer/single-consumer ring, where
+ * the consumer may have more than one reader (like the left and
+ * right channels of a stereo AudioBuffer), each moving through
+ * the blocks on its own. A block is only free to be written once
+ * every reader has finished with it. The reading side may run on
+ * an ISR or audio thread while the writing side runs on a worker
+ * thread, reset and startReadingAt should only be called while
+ * neither side is running.
+******************************************************************/
+
+#include "AudioConstants.hpp"
+#include <algorithm>
+#include <atomic>
+
+template <unsigned int numReaders = 1>
+class BlockRing
+{
+	public:
+		BlockRing() :
+			m_NumBlocks( 2 ),
+			m_ReadCounts{},
+			m_WriteCount( 0 )
+		{
+			static_assert( numReaders > 0, "BlockRing needs at least one reader" );
+
+			this->reset( m_NumBlocks );
+		}
+
+		unsigned int getNumBlocks() const { return m_NumBlocks; }
+
+		// every reader starts on the first block with all other blocks considered filled
+		void reset (unsigned int numBlocks)
+		{
+			m_NumBlocks = numBlocks;
+			for ( std::atomic<unsigned int>& readCount : m_ReadCounts )
+			{
+				readCount.store( 0, std::memory_order_relaxed );
+			}
+			m_WriteCount.store( m_NumBlocks, std::memory_order_release );
+		}
+
+		// every reader starts on readBlock with only that block considered filled, so every other block is free
+		void startReadingAt (unsigned int readBlock)
+		{
+			const unsigned int startCount = readBlock % m_NumBlocks;
+			for ( std::atomic<unsigned int>& readCount : m_ReadCounts )
+			{
+				readCount.store( startCount, std::memory_order_relaxed );
+			}
+			m_WriteCount.store( startCount + 1, std::memory_order_release );
+		}
+
+		// reading side, hands the block the reader has finished with back to the writing side and moves it on to the
+		// next block if that has been filled. Otherwise we've underrun and the reader should read the same block again
+		// rather than one that may be being written to. Either way, returns the block the reader should read next
+		inline unsigned int advanceRead (unsigned int reader = 0)
+		{
+			std::atomic<unsigned int>& readCount = m_ReadCounts[reader];
+			const unsigned int currentReadCount = readCount.load( std::memory_order_relaxed );
+			const unsigned int nextReadCount = this->nextCount( currentReadCount );
+
+			if ( nextReadCount == m_WriteCount.load(std::memory_order_acquire) )
+			{
+				return this->getBlockFromCount( currentReadCount );
+			}
+
+			readCount.store( nextReadCount, std::memory_order_release );
+
+			return this->getBlockFromCount( nextReadCount );
+		}
+
+		// writing side, calls fill with the index of every block all of the readers have finished with, in order
+		template <typename Fill>
+		void fillFreeBlocks (const Fill& fill)
+		{
+			unsigned int readCounts[numReaders];
+			for ( unsigned int reader = 0; reader < numReaders; reader++ )
+			{
+				readCounts[reader] = m_ReadCounts[reader].load( std::memory_order_acquire );
+			}
+			unsigned int writeCount = m_WriteCount.load( std::memory_order_relaxed );
+
+			while ( this->isFree(writeCount, readCounts) )
+			{
+				fill( this->getBlockFromCount(writeCount) );
+
+				writeCount = this->nextCount( writeCount );
+				m_WriteCount.store( writeCount, std::memory_order_release );
+			}
+		}
+
+		// the block the writing side fills next, once the readers have finished with it
+		unsigned int getNextWriteBlock() const
+		{
+			return this->getBlockFromCount( m_WriteCount.load(std::memory_order_acquire) );
+		}
+
+	private:
+		unsigned int 						m_NumBlocks;
+
+		// the counts run from 0 to (2 * m_NumBlocks) - 1 so that a full ring can be told apart from an empty one
+		alignas(CACHE_LINE_SIZE) std::atomic<unsigned int> 	m_ReadCounts[numReaders];
+		alignas(CACHE_LINE_SIZE) std::atomic<unsigned int> 	m_WriteCount;
+
+		inline unsigned int nextCount (unsigned int count) const { return ( count + 1 == m_NumBlocks * 2 ) ? 0 : count + 1; }
+		inline unsigned int getBlockFromCount (unsigned int count) const
+		{
+			return ( count < m_NumBlocks ) ? count : count - m_NumBlocks;
+		}
+		inline unsigned int numFilledBlocks (unsigned int writeCount, unsigned int readCount) const
+		{
+			return ( writeCount >= readCount ) ? writeCount - readCount : writeCount + (m_NumBlocks * 2) - readCount;
+		}
+		inline bool isFree (unsigned int writeCount, const unsigned int* readCounts) const
+		{
+			for ( unsigned int reader = 0; reader < numReaders; reader++ )
+			{
+				if ( this->numFilledBlocks(writeCount, readCounts[reader]) >= m_NumBlocks )
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+};
+
+// copies numSamples samples from readPtr to dst, then writes samplesToReadBuf (or zeros if null) back in their place, used
+// by the buffers that read through a BlockRing
+template <typename T>
+inline void readAndWriteBack (T* const readPtr, T* const dst, const T* const samplesToReadBuf, const unsigned int numSamples)
+{
+	if ( samplesToReadBuf == dst )
+	{
+		std::swap_ranges( readPtr, readPtr + numSamples, dst );
+	}
+	else
+	{
+		std::copy( readPtr, readPtr + numSamples, dst );
+
+		if ( samplesToReadBuf )
+		{
+			std::copy( samplesToReadBuf, samplesToReadBuf + numSamples, readPtr );
+		}
+		else
+		{
+			std::fill( readPtr, readPtr + numSamples, 0 );
+		}
+	}
+}
+
+#endif // BLOCKRING_HPP
@@ -9,13 +9,34 @@
 
 #include "IResponse.hpp"
 
-class ExponentialResponse : public IResponse
+#include <cmath>
+
+class ExponentialResponse final : public IResponse
 {
 	public:
 		ExponentialResponse (const float slope = 2.0f);
 		~ExponentialResponse() override;
 
-		float response (const float value, const float minValue, const float maxValue) const override;
+		inline float response (const float value, const float minValue, const float maxValue) const override
+		{
+			const float span = maxValue - minValue;
+			const float normalizedValue = value / span;
+			const float normalized = ( powf(m_Slope + 1, normalizedValue) - 1.0f ) / m_Slope;
+
+			return std::fmin( ((normalized * span) - std::abs(minValue)), maxValue );
+		}
+
+		inline bool getStepCoefficients (const float increment, const float minValue, const float maxValue,
+							float& multiplier, float& offset) const override
+		{
+			// each step multiplies the power by the same amount, so the response is multiplied by it too, plus an
+			// offset that keeps the - 1.0f, the slope division and the shift by minValue in place
+			const float span = maxValue - minValue;
+			multiplier = powf( m_Slope + 1, increment / span );
+			offset = ( multiplier - 1.0f ) * ( std::abs(minValue) + (span / m_Slope) );
+
+			return true;
+		}
 		void setSlope (const float slope) override;
 
 		float getSlope() override { return m_Slope; }
@@ -0,0 +1,31 @@
+#ifndef FIRKERNELS_HPP
+#define FIRKERNELS_HPP
+
+/*******************************************************************************
+ * The FIR kernels compute the dot product at the heart of FIR filtering
+ * (the sum of each history sample multiplied by its coefficient) using the
+ * fastest instruction set the cpu supports, chosen at runtime the first time
+ * firDotProduct is called.
+ *
+ * Every kernel accumulates the same 16 partial sums in the same order and
+ * reduces them the same way, so the SIMD kernels give results bit-identical
+ * to the scalar kernel, which is used wherever no SIMD kernel is available.
+*******************************************************************************/
+
+enum class FIRKernel : unsigned int
+{
+	SCALAR,
+	SSE2,
+	AVX2,
+	AVX512,
+	NEON
+};
+
+// history and coefficients both need numTaps contiguous floats, no alignment is required
+float firDotProduct (const float* const history, const float* const coefficients, const unsigned int numTaps);
+
+FIRKernel getFIRKernel();
+bool firKernelIsSupported (const FIRKernel kernel);
+bool setFIRKernel (const FIRKernel kernel); // returns false if the kernel isn't supported by this cpu
+
+#endif // FIRKERNELS_HPP
@@ -4,8 +4,18 @@
 /****************************************************************
  * An IBufferCallback is used to write to the write buffer of
  * an AudioBuffer. See AudioBuffer for more details.
+ *
+ * Implementations process blocks of any size through process,
+ * while call is kept for processing a full ABUFFER_SIZE block.
+ *
+ * An IMultiChannelBufferCallback does the same for a
+ * MultiChannelAudioBuffer, where the block is either interleaved
+ * (one frame of every channel after another) or planar (one
+ * buffer per channel).
 ****************************************************************/
 
+#include "AudioConstants.hpp"
+
 template <typename T=float, bool isStereo=false>
 class IBufferCallback;
 
@@ -14,7 +24,8 @@ class IBufferCallback<T, false>
 {
 	public:
 		virtual ~IBufferCallback() {}
-		virtual void call (T* writeBuffer) = 0;
+		virtual void call (T* writeBuffer) { this->process( writeBuffer, ABUFFER_SIZE ); }
+		virtual void process (T* writeBuffer, unsigned int numSamples) = 0;
 };
 
 template <typename T>
@@ -22,7 +33,33 @@ class IBufferCallback<T, true>
 {
 	public:
 		virtual ~IBufferCallback() {}
-		virtual void call (T* writeBufferL, T* writeBufferR) = 0;
+		virtual void call (T* writeBufferL, T* writeBufferR) { this->process( writeBufferL, writeBufferR, ABUFFER_SIZE ); }
+		virtual void process (T* writeBufferL, T* writeBufferR, unsigned int numSamples) = 0;
+};
+
+enum class ChannelLayout : unsigned int
+{
+	INTERLEAVED,
+	PLANAR
+};
+
+template <typename T, unsigned int numChannels, ChannelLayout layout>
+class IMultiChannelBufferCallback;
+
+template <typename T, unsigned int numChannels>
+class IMultiChannelBufferCallback<T, numChannels, ChannelLayout::INTERLEAVED>
+{
+	public:
+		virtual ~IMultiChannelBufferCallback() {}
+		virtual void process (T* writeBuffer, unsigned int numFrames) = 0; // writeBuffer holds numFrames * numChannels samples
+};
+
+template <typename T, unsigned int numChannels>
+class IMultiChannelBufferCallback<T, numChannels, ChannelLayout::PLANAR>
+{
+	public:
+		virtual ~IMultiChannelBufferCallback() {}
+		virtual void process (T* const* writeBuffers, unsigned int numFrames) = 0; // writeBuffers holds numChannels buffers
 };
 
 #endif
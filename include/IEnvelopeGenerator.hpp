@@ -14,6 +14,13 @@ class IEnvelopeGenerator : public IKeyEventListener
 	public:
 		virtual ~IEnvelopeGenerator() {}
 		virtual float nextValue() = 0;
+		virtual void render (float* out, unsigned int numValues)
+		{
+			for ( unsigned int value = 0; value < numValues; value++ )
+			{
+				out[value] = this->nextValue();
+			}
+		}
 		virtual float currentValue() = 0;
 		virtual void toStart() = 0;
 		virtual void toEnd() = 0;
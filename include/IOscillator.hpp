@@ -6,7 +6,8 @@ enum class OscillatorMode : unsigned int
 	SINE,
 	TRIANGLE,
 	SQUARE,
-	SAWTOOTH
+	SAWTOOTH,
+	WAVETABLE
 };
 
 class IOscillator
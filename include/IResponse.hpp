@@ -12,8 +12,13 @@ class IResponse
 	public:
 		virtual ~IResponse(){}
 		virtual float response (const float value, const float minValue, const float maxValue) const = 0;
-		virtual void setSlope (const float slope) {}
+		virtual void setSlope (const float /*slope*/) {}
 		virtual float getSlope() { return 0.0f; }
+
+		// responses that can be stepped with a multiply-add give the coefficients for it, so that moving the value by
+		// increment turns the response r into ( r * multiplier ) + offset. returns false for responses that can't be stepped
+		virtual bool getStepCoefficients (const float /*increment*/, const float /*minValue*/, const float /*maxValue*/,
+							float& /*multiplier*/, float& /*offset*/) const { return false; }
 };
 
 #endif // IRESPONSE_HPP
@@ -18,7 +18,7 @@ class Limiter : public IBufferCallback<T>
 		Limiter (float attackTimeMS, float releaseTimeMS, float peakThreshold, float makeupGain); // attack and release times in ms
 		~Limiter();
 
-		void call (T* writeBuffer) override;
+		void process (T* writeBuffer, unsigned int numSamples) override;
 
 	private:
 		float 		m_AttackTime;
@@ -8,13 +8,25 @@
 
 #include "IResponse.hpp"
 
-class LinearResponse : public IResponse
+class LinearResponse final : public IResponse
 {
 	public:
 		LinearResponse();
 		~LinearResponse() override;
 
-		float response(const float value, const float minValue, const float maxValue) const override;
+		inline float response (const float value, const float /*minValue*/, const float /*maxValue*/) const override
+		{
+			return value;
+		}
+
+		inline bool getStepCoefficients (const float increment, const float /*minValue*/, const float /*maxValue*/,
+							float& multiplier, float& offset) const override
+		{
+			multiplier = 1.0f;
+			offset = increment;
+
+			return true;
+		}
 };
 
 #endif // LINEARRESPONSE_HPP
@@ -0,0 +1,300 @@
+#ifndef MULTICHANNELAUDIOBUFFER_HPP
+#define MULTICHANNELAUDIOBUFFER_HPP
+
+/******************************************************************
+ * A MultiChannelAudioBuffer works the same as an AudioBuffer, but
+ * for any number of channels. Each block holds numFrames frames
+ * of numChannels samples, either interleaved (so a block can be
+ * handed straight to drivers that expect interleaved data) or
+ * planar (each channel's samples one after the other). Reading is
+ * done a frame at a time through a single frame cursor, so all
+ * channels always stay in step.
+ *
+ * Like the AudioBuffer, more than two blocks turns this into a
+ * lock-free single-producer/single-consumer ring, where
+ * getNextFrame is the reading side and pollToFillBuffers is the
+ * writing side.
+******************************************************************/
+
+#include "IBufferCallback.hpp"
+#include "BlockRing.hpp"
+
+#include "AudioConstants.hpp"
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+template <typename T, unsigned int numChannels, ChannelLayout layout = ChannelLayout::INTERLEAVED>
+class MultiChannelAudioBuffer
+{
+	public:
+		using Callback = IMultiChannelBufferCallback<T, numChannels, layout>;
+		// what readFrames reads into, one buffer of interleaved frames or one buffer per channel
+		using FramesPtr = typename std::conditional<layout == ChannelLayout::INTERLEAVED, T*, T* const*>::type;
+		using ConstFramesPtr = typename std::conditional<layout == ChannelLayout::INTERLEAVED, const T*, const T* const*>::type;
+
+		MultiChannelAudioBuffer (unsigned int numFrames = ABUFFER_SIZE, unsigned int numBlocks = 2) :
+			m_NumFrames( 0 ),
+			m_NumBlocks( 0 ),
+			m_Buffers( nullptr ),
+			m_Ring(),
+			m_CurrentBuffer( nullptr ),
+			m_Pos( 0 ),
+			m_Callbacks()
+		{
+			static_assert( numChannels > 0, "MultiChannelAudioBuffer needs at least one channel" );
+
+			this->allocateBuffers( numFrames, numBlocks );
+		}
+
+		MultiChannelAudioBuffer (const MultiChannelAudioBuffer& other) :
+			m_NumFrames( 0 ),
+			m_NumBlocks( 0 ),
+			m_Buffers( nullptr ),
+			m_Ring(),
+			m_CurrentBuffer( nullptr ),
+			m_Pos( 0 ),
+			m_Callbacks( other.getCallbacks() )
+		{
+			this->allocateBuffers( other.getNumFrames(), other.getNumBlocks() );
+			std::copy( other.getBlock(0), other.getBlock(0) + this->getNumSamplesTotal(), m_Buffers );
+		}
+
+		~MultiChannelAudioBuffer()
+		{
+			delete[] m_Buffers;
+		}
+
+		MultiChannelAudioBuffer& operator= (const MultiChannelAudioBuffer& other)
+		{
+			if ( this == &other )
+			{
+				return *this;
+			}
+
+			this->allocateBuffers( other.getNumFrames(), other.getNumBlocks() );
+			std::copy( other.getBlock(0), other.getBlock(0) + this->getNumSamplesTotal(), m_Buffers );
+			m_Callbacks = other.getCallbacks();
+
+			return *this;
+		}
+
+		unsigned int getNumChannels() const { return numChannels; }
+		ChannelLayout getLayout() const { return layout; }
+
+		unsigned int getNumFrames() const { return m_NumFrames; }
+		// reallocates the buffers, so don't call from the audio thread
+		void setNumFrames (unsigned int numFrames) { this->allocateBuffers( numFrames, m_NumBlocks ); }
+
+		unsigned int getNumBlocks() const { return m_NumBlocks; }
+		// must be at least 2, reallocates the buffers like setNumFrames
+		void setNumBlocks (unsigned int numBlocks) { this->allocateBuffers( m_NumFrames, numBlocks ); }
+
+		// index of a sample within a block
+		inline unsigned int getSampleIndex (unsigned int frame, unsigned int channel) const
+		{
+			if constexpr ( layout == ChannelLayout::INTERLEAVED )
+			{
+				return ( frame * numChannels ) + channel;
+			}
+			else
+			{
+				return ( channel * m_NumFrames ) + frame;
+			}
+		}
+
+		// copies the next frame of numChannels samples to frame, and if we're also reading data (from ADC for example)
+		// frameToReadBuf is written back into the 'read' buffer, otherwise zeros are
+		void getNextFrame (T* frame, const T* frameToReadBuf = nullptr)
+		{
+			for ( unsigned int channel = 0; channel < numChannels; channel++ )
+			{
+				T& sample = m_CurrentBuffer[ this->getSampleIndex(m_Pos, channel) ];
+				frame[channel] = sample;
+				sample = ( frameToReadBuf ) ? frameToReadBuf[channel] : 0;
+			}
+
+			m_Pos++;
+			if ( m_Pos == m_NumFrames )
+			{
+				m_Pos = 0;
+
+				this->advanceReadBlock();
+			}
+		}
+
+		// same as above, but copies numFrames frames (which may cross blocks) to dsts in bulk. For the interleaved layout
+		// dsts and framesToReadBufs are single buffers of interleaved frames, for the planar layout they're numChannels
+		// buffers, one per channel. framesToReadBufs may be the same as dsts but may not otherwise overlap it
+		void readFrames (FramesPtr dsts, unsigned int numFrames, ConstFramesPtr framesToReadBufs = nullptr)
+		{
+			unsigned int framesCopied = 0;
+			while ( framesCopied < numFrames )
+			{
+				// copy up to the end of the current block at most
+				const unsigned int numToCopy = std::min( numFrames - framesCopied, m_NumFrames - m_Pos );
+
+				if constexpr ( layout == ChannelLayout::INTERLEAVED )
+				{
+					T* const readPtr = &m_CurrentBuffer[ this->getSampleIndex(m_Pos, 0) ];
+					const unsigned int offset = framesCopied * numChannels;
+					const T* const toReadBuf = ( framesToReadBufs ) ? &framesToReadBufs[offset] : nullptr;
+
+					readAndWriteBack( readPtr, &dsts[offset], toReadBuf, numToCopy * numChannels );
+				}
+				else
+				{
+					for ( unsigned int channel = 0; channel < numChannels; channel++ )
+					{
+						T* const readPtr = &m_CurrentBuffer[ this->getSampleIndex(m_Pos, channel) ];
+						const T* const channelToReadBuf = ( framesToReadBufs ) ? &framesToReadBufs[channel][framesCopied] : nullptr;
+
+						readAndWriteBack( readPtr, &dsts[channel][framesCopied], channelToReadBuf, numToCopy );
+					}
+				}
+
+				framesCopied += numToCopy;
+				m_Pos += numToCopy;
+
+				if ( m_Pos == m_NumFrames )
+				{
+					m_Pos = 0;
+
+					this->advanceReadBlock();
+				}
+			}
+		}
+
+		// sets the block the reading side is on, all other blocks will be filled on the next poll
+		void triggerCallbacksOnNextPoll (unsigned int readBlock)
+		{
+			m_Ring.startReadingAt( readBlock );
+			m_CurrentBuffer = this->getBlock( readBlock % m_NumBlocks );
+		}
+
+		// fills every block the reading side has finished with
+		void pollToFillBuffers()
+		{
+			this->fillFreeBlocks( [this] (T* writeBuffer)
+						{
+							for ( Callback* callback : m_Callbacks )
+							{
+								this->template callProcess<false>( *callback, writeBuffer );
+							}
+						} );
+		}
+
+		// same as above, but calls the given callbacks in order without virtual dispatch instead of the callback chain
+		template <typename... Callbacks>
+		void pollToFillBuffers (Callbacks&... callbacks)
+		{
+			this->fillFreeBlocks( [this, &callbacks...] (T* writeBuffer)
+						{ ( this->template callProcess<true>(callbacks, writeBuffer), ... ); } );
+		}
+
+		// blocks are numFrames * numChannels samples laid out according to the layout
+		T* getBlock (unsigned int block) { return &m_Buffers[ block * m_NumFrames * numChannels ]; }
+		const T* getBlock (unsigned int block) const { return &m_Buffers[ block * m_NumFrames * numChannels ]; }
+
+		const std::vector<Callback*>& getCallbacks() const { return m_Callbacks; }
+
+		// appends to the end of the callback chain
+		void registerCallback (Callback* callback) { this->registerCallback( callback, m_Callbacks.size() ); }
+
+		// inserts before the given position
+		void registerCallback (Callback* callback, unsigned int position)
+		{
+			if ( callback && std::find(m_Callbacks.begin(), m_Callbacks.end(), callback) == m_Callbacks.end() )
+			{
+				position = std::min( position, static_cast<unsigned int>(m_Callbacks.size()) );
+				m_Callbacks.insert( m_Callbacks.begin() + position, callback );
+			}
+		}
+
+		void unregisterCallback (Callback* callback)
+		{
+			m_Callbacks.erase( std::remove(m_Callbacks.begin(), m_Callbacks.end(), callback), m_Callbacks.end() );
+		}
+
+	private:
+		unsigned int 	m_NumFrames;
+		unsigned int 	m_NumBlocks;
+		T* 		m_Buffers;
+
+		BlockRing<1> 	m_Ring;
+
+		// read side
+		T* 		m_CurrentBuffer;
+		unsigned int 	m_Pos;
+
+		// write side
+		std::vector<Callback*> 	m_Callbacks;
+
+		unsigned int getNumSamplesTotal() const { return m_NumFrames * numChannels * m_NumBlocks; }
+
+		void allocateBuffers (unsigned int numFrames, unsigned int numBlocks)
+		{
+			if ( numBlocks < 2 )
+			{
+				numBlocks = 2;
+			}
+
+			if ( numFrames != m_NumFrames || numBlocks != m_NumBlocks )
+			{
+				delete[] m_Buffers;
+				m_NumFrames = numFrames;
+				m_NumBlocks = numBlocks;
+				m_Buffers = new T[this->getNumSamplesTotal()]{ 0 };
+			}
+
+			// the reading side starts on the first block with all other blocks considered filled
+			m_Ring.reset( m_NumBlocks );
+			m_CurrentBuffer = m_Buffers;
+			m_Pos = 0;
+		}
+
+		void advanceReadBlock()
+		{
+			m_CurrentBuffer = this->getBlock( m_Ring.advanceRead() );
+		}
+
+		template <typename Fill>
+		void fillFreeBlocks (const Fill& fill)
+		{
+			m_Ring.fillFreeBlocks( [this, &fill] (unsigned int block) { fill(this->getBlock(block)); } );
+		}
+
+		// when devirtualize is true, qualified calls are used so that concrete callbacks aren't virtually dispatched
+		template <bool devirtualize, typename CallbackType>
+		inline void callProcess (CallbackType& callback, T* writeBuffer)
+		{
+			auto process = [&callback] (auto writeBuffers, unsigned int numFrames)
+			{
+				if constexpr ( devirtualize )
+				{
+					callback.CallbackType::process( writeBuffers, numFrames );
+				}
+				else
+				{
+					callback.process( writeBuffers, numFrames );
+				}
+			};
+
+			if constexpr ( layout == ChannelLayout::INTERLEAVED )
+			{
+				process( writeBuffer, m_NumFrames );
+			}
+			else
+			{
+				T* writeBuffers[numChannels];
+				for ( unsigned int channel = 0; channel < numChannels; channel++ )
+				{
+					writeBuffers[channel] = &writeBuffer[ channel * m_NumFrames ];
+				}
+
+				process( static_cast<T* const*>(writeBuffers), m_NumFrames );
+			}
+		}
+};
+
+#endif // MULTICHANNELAUDIOBUFFER_HPP
@@ -19,7 +19,7 @@ class NoiseGate : public IBufferCallback<T>
 		NoiseGate (float attackReleaseTimeMS, float holdTimeMS, T peakThreshold); // attack/release and hold times in ms
 		~NoiseGate();
 
-		void call (T* writeBuffer) override;
+		void process (T* writeBuffer, unsigned int numSamples) override;
 
 	private:
 		float 	m_AttackReleaseTime;
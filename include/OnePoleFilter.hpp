@@ -24,7 +24,7 @@ class OnePoleFilter : public IFilter<T>, public IBufferCallback<T>
 		void setResonance (float resonance) override {}
 		float getResonance() override { return 0.0f; }
 
-		void call (T* writeBuffer) override;
+		void process (T* writeBuffer, unsigned int numSamples) override;
 
 	private:
 		float m_A0;
@@ -0,0 +1,189 @@
+#ifndef OSCILLATORBANK_HPP
+#define OSCILLATORBANK_HPP
+
+/*******************************************************************************
+ * An OscillatorBank renders many oscillators at once that sound the same as a
+ * PolyBLEPOsc with the polynomial BLEP, for example every oscillator of every
+ * voice in a patch. Instead of one object per oscillator, the phases,
+ * increments, modes and triangle filter states are kept in arrays, and each
+ * sample is rendered for all of the oscillators in one branchless loop. This
+ * lets the compiler render 4 (SSE, NEON), 8 (AVX) or 16 (AVX-512) oscillators
+ * per instruction. Every waveform is calculated for every oscillator and mixed
+ * with gains of 0 or 1 set by each oscillator's mode, which is cheaper than
+ * branching per oscillator once the loop is vectorized. Sines are read from
+ * the shared sine table afterwards, one oscillator at a time, since table
+ * lookups don't vectorize.
+ *
+ * Frames are interleaved, one sample per oscillator, like a
+ * MultiChannelAudioBuffer with an oscillator per channel. Like PolyBLEPOsc,
+ * the phase is a 32 bit integer where a whole cycle is 2^32, so it wraps on
+ * its own in either direction and never drifts.
+ *
+ * The bank only plays the band-limited modes and sine, oscillators in
+ * wavetable mode are silent. It has no modulation inputs, windowed sinc
+ * BLEPs or pulse width, for those use a PolyBLEPOsc.
+*******************************************************************************/
+
+#include "IBufferCallback.hpp"
+#include "IOscillator.hpp"
+#include "Wavetable.hpp"
+
+#define _USE_MATH_DEFINES
+
+#include "AudioConstants.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdint.h>
+
+template <unsigned int numOscillators>
+class OscillatorBank : public IMultiChannelBufferCallback<float, numOscillators, ChannelLayout::INTERLEAVED>
+{
+	public:
+		OscillatorBank() :
+			m_SineTable( Wavetable::getSineTable().get() )
+		{
+			static_assert( numOscillators > 0, "OscillatorBank needs at least one oscillator" );
+
+			for ( unsigned int osc = 0; osc < numOscillators; osc++ )
+			{
+				this->setOscillatorMode( osc, OscillatorMode::SINE );
+				m_LastOutput[osc] = 0.0f;
+				m_LastLastOutput[osc] = 0.0f;
+				this->setFrequency( osc, 0.0f );
+				this->resetPhase( osc );
+			}
+		}
+		~OscillatorBank() override {}
+
+		void setFrequency (const unsigned int osc, const float frequency)
+		{
+			m_Frequency[osc] = frequency;
+
+			// the same increment as PolyBLEPOsc::setFrequency, negative frequencies wrap around to count the phase down
+			m_PhaseIncr[osc] = static_cast<uint32_t>( std::llround(static_cast<double>(frequency) * 4294967296.0 / SAMPLE_RATE) );
+
+			// the blep width is always positive, since the frequency can be negative
+			m_BLEPWidth[osc] = std::abs( frequency / SAMPLE_RATE );
+			m_InvBLEPWidth[osc] = ( m_BLEPWidth[osc] > 0.0f ) ? 1.0f / m_BLEPWidth[osc] : 0.0f;
+
+			// the same filter as PolyBLEPOsc::applyTriangleFilter, which only needs to change with the frequency
+			m_B1[osc] = expf( -2.0f * M_PI * (std::abs(frequency) / SAMPLE_RATE / 2.0f) );
+			m_A0[osc] = 1.0f - m_B1[osc];
+		}
+		float getFrequency (const unsigned int osc) const { return m_Frequency[osc]; }
+
+		void setOscillatorMode (const unsigned int osc, const OscillatorMode mode)
+		{
+			m_Mode[osc] = mode;
+			m_SawGain[osc] = ( mode == OscillatorMode::SAWTOOTH ) ? 1.0f : 0.0f;
+			m_SquareGain[osc] = ( mode == OscillatorMode::SQUARE ) ? 1.0f : 0.0f;
+			m_TriangleGain[osc] = ( mode == OscillatorMode::TRIANGLE ) ? 1.0f : 0.0f;
+		}
+		OscillatorMode getOscillatorMode (const unsigned int osc) const { return m_Mode[osc]; }
+
+		void resetPhase (const unsigned int osc) { m_Phase[osc] = 0; }
+
+		// allocates the first time a size is used, so this shouldn't be called on the audio thread. The table is swapped
+		// atomically and picked up at the start of the next block, so it can be called while the bank is playing
+		void setSineTableSize (const unsigned int size)
+		{
+			m_SineTable.store( Wavetable::getSineTable(size).get(), std::memory_order_release );
+		}
+		unsigned int getSineTableSize() const { return m_SineTable.load( std::memory_order_acquire )->getSize(); }
+
+		static constexpr unsigned int getNumOscillators() { return numOscillators; }
+
+		// writeBuffer holds numFrames * numOscillators samples
+		void process (float* writeBuffer, unsigned int numFrames) override
+		{
+			// the state is copied into locals for the block, so the compiler knows the output can't overwrite it
+			alignas(CACHE_LINE_SIZE) uint32_t phase[numOscillators];
+			alignas(CACHE_LINE_SIZE) float lastOutput[numOscillators];
+			alignas(CACHE_LINE_SIZE) float lastLastOutput[numOscillators];
+			alignas(CACHE_LINE_SIZE) float sinePhase[numOscillators];
+			std::copy( m_Phase, m_Phase + numOscillators, phase );
+			std::copy( m_LastOutput, m_LastOutput + numOscillators, lastOutput );
+			std::copy( m_LastLastOutput, m_LastLastOutput + numOscillators, lastLastOutput );
+			const Wavetable& sineTable = *m_SineTable.load( std::memory_order_acquire );
+
+			for ( unsigned int frame = 0; frame < numFrames; frame++ )
+			{
+				float* const frameOut = &writeBuffer[frame * numOscillators];
+
+				for ( unsigned int osc = 0; osc < numOscillators; osc++ )
+				{
+					// the top 24 bits of the phase, which a float holds exactly, scaled to 0 to 1
+					const float t = static_cast<float>( static_cast<int32_t>(phase[osc] >> 8) ) * ( 1.0f / 16777216.0f );
+					const float secondHalf = gainIf( t >= 0.5f );
+					const float halfT = t + 0.5f - secondHalf;
+					const float blep = polyBLEP( t, m_BLEPWidth[osc], m_InvBLEPWidth[osc] );
+					const float halfBLEP = polyBLEP( halfT, m_BLEPWidth[osc], m_InvBLEPWidth[osc] );
+
+					const float saw = ( 2.0f * t ) - 1.0f - blep;
+					const float square = ( 1.0f - (2.0f * secondHalf) ) + blep - halfBLEP;
+
+					// doing some filtering to make a triangle wave, the filter state only moves for triangle oscillators
+					const float triangleGain = m_TriangleGain[osc];
+					const float newLastLastOutput = ( square * m_A0[osc] ) + ( lastOutput[osc] * m_B1[osc] );
+					const float triangle = ( lastOutput[osc] * m_A0[osc] ) + ( newLastLastOutput * m_B1[osc] );
+					lastLastOutput[osc] = ( newLastLastOutput * triangleGain ) + ( lastLastOutput[osc] * (1.0f - triangleGain) );
+					lastOutput[osc] = ( triangle * triangleGain ) + ( lastOutput[osc] * (1.0f - triangleGain) );
+
+					sinePhase[osc] = t;
+					frameOut[osc] = ( saw * m_SawGain[osc] ) + ( square * m_SquareGain[osc] )
+							+ ( triangle * triangleGain );
+
+					// the phase wraps on its own, in either direction
+					phase[osc] += m_PhaseIncr[osc];
+				}
+
+				// the table lookups can't be vectorized without gathers, so the sine oscillators are added separately
+				for ( unsigned int osc = 0; osc < numOscillators; osc++ )
+				{
+					if ( m_Mode[osc] == OscillatorMode::SINE )
+					{
+						frameOut[osc] += sineTable.lookup( sinePhase[osc] );
+					}
+				}
+			}
+
+			std::copy( phase, phase + numOscillators, m_Phase );
+			std::copy( lastOutput, lastOutput + numOscillators, m_LastOutput );
+			std::copy( lastLastOutput, lastLastOutput + numOscillators, m_LastLastOutput );
+		}
+
+	private:
+		alignas(CACHE_LINE_SIZE) uint32_t 	m_Phase[numOscillators];
+		alignas(CACHE_LINE_SIZE) uint32_t 	m_PhaseIncr[numOscillators]; // counts down for negative frequencies
+		alignas(CACHE_LINE_SIZE) float 	m_BLEPWidth[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_InvBLEPWidth[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_LastOutput[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_LastLastOutput[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_A0[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_B1[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_SawGain[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_SquareGain[numOscillators];
+		alignas(CACHE_LINE_SIZE) float 	m_TriangleGain[numOscillators];
+		OscillatorMode 			m_Mode[numOscillators];
+		float 				m_Frequency[numOscillators];
+		std::atomic<const Wavetable*> 	m_SineTable; // sine tables are never freed, so the bank doesn't need to own it
+
+		// 1 if the condition is true and 0 if it isn't, going through an int keeps the compiler from turning it back into a branch
+		static inline float gainIf (const bool condition) { return static_cast<float>( static_cast<int>(condition) ); }
+
+		// the polyBLEP residual, the comparisons are turned into gains of 0 or 1 instead of branches so it vectorizes
+		static inline float polyBLEP (const float t, const float width, const float invWidth)
+		{
+			const float startGain = gainIf( t < width ); // just after the discontinuity
+			const float endGain = gainIf( t > 1.0f - width ) * ( 1.0f - startGain ); // just before it
+			const float start = t * startGain * invWidth;
+			const float end = ( t - 1.0f ) * endGain * invWidth;
+			const float startBLEP = start + start - ( start * start ) - 1.0f;
+			const float endBLEP = ( end * end ) + end + end + 1.0f;
+
+			return ( startBLEP * startGain ) + ( endBLEP * endGain );
+		}
+};
+
+#endif // OSCILLATORBANK_HPP
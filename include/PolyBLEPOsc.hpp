@@ -4,10 +4,83 @@
 /*******************************************************************************
  * A PolyBLEPOsc is a band-limited oscillator that can be used to produce
  * audible oscillations.
+ *
+ * Sine waves are read from a shared sine table with linear interpolation on
+ * every platform, so they only cost a few multiply-adds per sample. The
+ * table size trades memory for accuracy (see Wavetable for the error bounds),
+ * the default 1024 points is within 4.8e-6 of a true sine. The wavetable
+ * mode plays any single cycle table the same way. The oscillator only keeps
+ * pointers to its tables, which are swapped atomically and picked up at the
+ * start of each block (or each nextSample), so setSineTableSize and
+ * setWavetable can be called from another thread while it's playing.
+ *
+ * The phase is a 32 bit integer where a whole cycle is 2^32, so it wraps on
+ * its own and never drifts, the period is exact to within the frequency's
+ * rounding to a step of SAMPLE_RATE / 2^32 hz. process checks the mode once
+ * per block and renders the whole block with a loop made for that mode, so
+ * the per sample work is only what that waveform needs.
+ *
+ * The discontinuities of the sawtooth, square and triangle waves are smoothed
+ * with one of two band-limited steps (BLEPs):
+ *
+ * 	POLYNOMIAL: a 2 sample polynomial, the cheapest
+ * 	WINDOWED_SINC: a blackman windowed sinc step across
+ * 		       SINC_BLEP_ZERO_CROSSINGS samples on either side, read
+ * 		       from a table. Aliasing is much lower in the high
+ * 		       register, for a table read instead of a polynomial on
+ * 		       SINC_BLEP_ZERO_CROSSINGS times as many samples around
+ * 		       each discontinuity
+ *
+ * processModulated renders a block with audio rate modulation from buffers
+ * instead of calling the setters every sample:
+ *
+ * 	frequency: the frequency in hz of each sample, which can go through 0
+ * 		   for through-zero FM
+ * 	phase: an offset in cycles added to the phase for phase modulation
+ * 	sync: hard sync, negative if the sync source didn't start a new cycle
+ * 	      during the sample, otherwise how long ago (0 to 1 samples) it did
+ * 	pulseWidth: the fraction of the cycle the square wave is high for, so
+ * 		    0.5 is a square wave
+ * 	syncOut: written in the same format as sync, so this oscillator can be
+ * 		 the sync source of another one
+ *
+ * Any of them can be nullptr. Modulated frequencies at or past the nyquist
+ * frequency are clamped to just below it. Sync resets are smoothed with a
+ * PolyBLEP scaled to the size of the jump, and the half of it before the
+ * reset is added to the previous sample, except at the start of a block where
+ * both halves go to the first sample. Blocks with a sync buffer use the
+ * polynomial BLEP whatever the BLEP quality is set to, since a reset cancels
+ * the wrap the phase was heading for and a windowed sinc BLEP would already
+ * have spread that wrap over samples that can't be changed anymore. Triangle
+ * waves are filtered pulse waves, so they follow the pulse width too, but the
+ * triangle filter keeps the frequency it had the last time
+ * applyTriangleFilter was called.
 *******************************************************************************/
 
 #include "IOscillator.hpp"
 #include "IBufferCallback.hpp"
+#include "Wavetable.hpp"
+
+#include <atomic>
+#include <stdint.h>
+
+constexpr unsigned int SINC_BLEP_ZERO_CROSSINGS = 8;
+constexpr unsigned int SINC_BLEP_OVERSAMPLING = 64; // table points per sample
+
+enum class BLEPQuality : unsigned int
+{
+	POLYNOMIAL,
+	WINDOWED_SINC
+};
+
+struct PolyBLEPModulation
+{
+	const float* 	frequency = nullptr;
+	const float* 	phase = nullptr;
+	const float* 	sync = nullptr;
+	const float* 	pulseWidth = nullptr;
+	float* 		syncOut = nullptr;
+};
 
 class PolyBLEPOsc : public IOscillator, public IBufferCallback<float>
 {
@@ -23,17 +96,59 @@ class PolyBLEPOsc : public IOscillator, public IBufferCallback<float>
 
 		void applyTriangleFilter(); // if using triangle, this should be called at least once per block
 
-		void call (float* writeBuffer) override;
+		// allocates the first time a size is used, so this shouldn't be called on the audio thread
+		void setSineTableSize (const unsigned int size);
+		unsigned int getSineTableSize() const { return m_SineTable.load( std::memory_order_acquire )->getSize(); }
+		// the table played in wavetable mode, which is silent while it's nullptr. The caller owns the table, and it has to
+		// outlive the block being rendered when it's replaced, so free it on the audio thread or after the next block
+		void setWavetable (const Wavetable* const wavetable) { m_Wavetable.store( wavetable, std::memory_order_release ); }
+		const Wavetable* getWavetable() const { return m_Wavetable.load( std::memory_order_acquire ); }
+
+		void setBLEPQuality (const BLEPQuality quality) { m_BLEPQuality = quality; }
+		BLEPQuality getBLEPQuality() const { return m_BLEPQuality; }
+
+		void process (float* writeBuffer, unsigned int numSamples) override;
+		// every buffer in modulation that isn't nullptr holds numSamples values
+		void processModulated (float* writeBuffer, unsigned int numSamples, const PolyBLEPModulation& modulation);
 
 	private:
 		float m_Frequency;
-		float m_Phase;
-		float m_PhaseIncr;
+		uint32_t m_Phase;
+		uint32_t m_PhaseIncr; // counts down for negative frequencies
+		float m_BLEPWidth; // the phase increment as a fraction of a cycle, without its sign
+		float m_InvBLEPWidth;
 		float m_LastOutput;
 		float m_LastLastOutput;
 		float m_A0;
 		float m_B1;
+		float m_SyncOut; // the sync output for the next sample, since the phase wraps after a sample is rendered
 		OscillatorMode m_OscMode;
+		BLEPQuality m_BLEPQuality;
+		std::atomic<const Wavetable*> m_SineTable; // sine tables are never freed, so the oscillator doesn't need to own it
+		std::atomic<const Wavetable*> m_Wavetable;
+		const Wavetable* m_BlockSineTable; // the tables being read, loaded once per block so they can't change partway through
+		const Wavetable* m_BlockWavetable;
+
+		inline void loadTables()
+		{
+			m_BlockSineTable = m_SineTable.load( std::memory_order_acquire );
+			m_BlockWavetable = m_Wavetable.load( std::memory_order_acquire );
+		}
+
+		template <OscillatorMode mode, BLEPQuality quality> inline float renderWaveform (const float t, const float width,
+													const float invWidth, const float pulseWidth) const;
+		template <OscillatorMode mode, BLEPQuality quality> inline float wrapBLEP (const float t, const float width,
+												const float invWidth) const;
+		template <OscillatorMode mode> inline float naiveWaveform (const float t, const float pulseWidth) const;
+		inline float filterTriangle (const float pulse);
+		template <OscillatorMode mode, BLEPQuality quality> inline float renderSample();
+		template <OscillatorMode mode, BLEPQuality quality> void renderBlock (float* writeBuffer, unsigned int numSamples);
+		template <OscillatorMode mode, BLEPQuality quality> void renderModulatedBlock (float* writeBuffer, unsigned int numSamples,
+												const PolyBLEPModulation& modulation);
+		template <BLEPQuality quality> float nextSampleWithQuality();
+		template <BLEPQuality quality> void processWithQuality (float* writeBuffer, unsigned int numSamples);
+		template <BLEPQuality quality> void processModulatedWithQuality (float* writeBuffer, unsigned int numSamples,
+											const PolyBLEPModulation& modulation);
 };
 
 #endif // POLYBLEPOSC_HPP
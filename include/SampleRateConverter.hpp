@@ -9,23 +9,103 @@
  *
  * For typical implementation, look at getNextAudioBlock in MainComponent.cpp in
  * the AkiDelay project.
+ *
+ * Both directions work whether the target rate is above or below the source
+ * rate. Source-to-target conversion takes a full source buffer and returns
+ * the number of target samples written. The target buffer needs room for
+ * ceil(getFractionalTargetBufferSize()) + 1 samples. Target-to-source
+ * conversion fills a full source buffer. None of the conversion or filter
+ * functions allocate; all of their buffers are sized when the rates, buffer
+ * size or quality change. When downsampling, the filter runs
+ * before the conversion; when upsampling, it runs after.
+ *
+ * The interpolation quality can be linear (2 points), 4-point hermite, or a
+ * band-limited windowed sinc (using the anti-aliasing filter's window) that
+ * does the interpolation and anti-aliasing in one pass. In sinc mode the
+ * filter functions do nothing, so they can be called unconditionally. Higher
+ * qualities look at more input samples, which adds a few samples of delay.
+ * The total delay of each direction (interpolation plus filter group delay)
+ * is reported by the latency functions so hosts can compensate for it. The
+ * filters can be switched to minimum phase to cut the latency of live
+ * monitoring paths, at the cost of linear phase.
+ *
+ * In asynchronous mode the target clock is assumed to drift away from the
+ * nominal target rate (for example an MCU-clocked device bridged to a USB
+ * audio interface). The effective target rate is continuously corrected by
+ * a smoothed control loop fed either by the fill level of the buffer between
+ * the converter and the device (updateFillLevel, once per source buffer),
+ * by a target rate measured from timestamps (updateMeasuredTargetRate), or
+ * both. The fill level loop holds the fill level at its target, which keeps
+ * the latency bounded without under- or over-running the buffer.
+ *
+ * Any number of channels can be converted in lockstep by setting numChannels.
+ * The buffers are then interleaved (like MultiChannelAudioBuffer's default),
+ * buffer sizes and sample counts are in frames, and the phase and
+ * interpolation weights are shared by all channels, so they're only
+ * calculated once per frame.
+ *
+ * Whole files can be converted offline (for rendering or asset preparation)
+ * with the offline functions, which split the span into chunks converted in
+ * parallel. Each chunk warms up its filters and interpolation history on the
+ * frames before it, so the output is bit-identical to streaming the same
+ * frames through a freshly constructed synchronous converter.
 *******************************************************************************/
 
 #include "AntiAliasingFilter.hpp"
 
-template <typename SType, typename TType>
+#include <vector>
+
+enum class InterpolationQuality : unsigned int
+{
+	LINEAR,
+	HERMITE,
+	SINC
+};
+
+constexpr unsigned int SRC_SINC_TAPS = 32;
+constexpr unsigned int SRC_SINC_PHASES = 256; // coefficients are linearly interpolated between phases
+constexpr float SRC_SINC_ROLLOFF = 0.9f; // the sinc cutoff as a fraction of the lower nyquist frequency
+
+constexpr unsigned int SRC_ASYNC_FRAC_DENOMINATOR = 1u << 31; // the phase resolution in asynchronous mode
+constexpr float SRC_DEFAULT_MAX_DRIFT = 0.001f; // 1000 ppm
+constexpr float SRC_DEFAULT_DRIFT_CONTROL_TIME = 2.0f; // in seconds
+constexpr float SRC_FILL_LEVEL_SMOOTHING = 0.1f; // the fill level smoothing time as a fraction of the drift control time
+
+constexpr unsigned int SRC_OFFLINE_CHUNK_FRAMES = 16384; // output frames per chunk in offline conversion
+
+constexpr unsigned int getInterpolationPoints (const InterpolationQuality quality)
+{
+	return ( quality == InterpolationQuality::SINC ) ? SRC_SINC_TAPS : ( quality == InterpolationQuality::HERMITE ) ? 4 : 2;
+}
+
+template <typename SType, typename TType, unsigned int numChannels = 1>
 class SampleRateConverter
 {
 	public:
 		SampleRateConverter (const unsigned int initialSourceRate, const unsigned int initialTargetRate,
-					const unsigned int initialSourceBufferSize);
+					const unsigned int initialSourceBufferSize, const unsigned int aaFilterOrder = 63,
+					const FilterWindow aaFilterWindow = FilterWindow::HAMMING,
+					const float aaFilterKaiserBeta = DEFAULT_KAISER_BETA,
+					const FilterPhase aaFilterPhase = FilterPhase::LINEAR);
 		~SampleRateConverter() {}
 
-		// TODO still need to write convertFromSourceToTargetUpsampling and convertFromTargetToSourceDownsampling, I'm tired
-		// returns the number of samples converted
+		// returns the number of frames converted
 		unsigned int convertFromSourceToTargetDownsampling (const SType* const sourceBuffer, TType* const targetBuffer);
+		unsigned int convertFromSourceToTargetUpsampling (const SType* const sourceBuffer, TType* const targetBuffer);
 		unsigned int convertFromTargetToSourceUpsampling (const TType* const targetBuffer, const unsigned int targetBufferSize,
 									SType* const sourceBuffer);
+		unsigned int convertFromTargetToSourceDownsampling (const TType* const targetBuffer, const unsigned int targetBufferSize,
+									SType* const sourceBuffer);
+
+		// offline conversion of a whole span, using numThreads threads (0 uses one per core). These use the nominal rates even in
+		// asynchronous mode and use the current filter settings as if resetAAFilters had been called. They allocate, but don't
+		// touch the streaming state. Returns the number of frames written, see getOfflineTargetFrames and getOfflineSourceFrames
+		unsigned int convertFromSourceToTargetOffline (const SType* const sourceBuffer, const unsigned int numSourceFrames,
+								TType* const targetBuffer, const unsigned int numThreads = 0) const;
+		unsigned int convertFromTargetToSourceOffline (const TType* const targetBuffer, const unsigned int numTargetFrames,
+								SType* const sourceBuffer, const unsigned int numThreads = 0) const;
+		unsigned int getOfflineTargetFrames (const unsigned int numSourceFrames) const;
+		unsigned int getOfflineSourceFrames (const unsigned int numTargetFrames) const;
 
 		void filterSourceToTargetDownsampling (SType* const buffer);
 		void filterSourceToTargetUpsampling (TType* const buffer, const unsigned int bufferSize); // since target buffer can be fractional
@@ -36,38 +116,132 @@ class SampleRateConverter
 		void setTargetRate (const unsigned int targetRate);
 		void setSourceBufferSize (const unsigned int sourceBufferSize);
 		void resetAAFilters();
+		// these take effect on the next call to resetAAFilters
+		void setAAFilterOrder (const unsigned int aaFilterOrder) { m_AAFilterOrder = aaFilterOrder; }
+		void setAAFilterWindow (const FilterWindow aaFilterWindow, const float aaFilterKaiserBeta = DEFAULT_KAISER_BETA)
+		{
+			m_AAFilterWindow = aaFilterWindow;
+			m_AAFilterKaiserBeta = aaFilterKaiserBeta;
+		}
+		void setAAFilterPhase (const FilterPhase aaFilterPhase) { m_AAFilterPhase = aaFilterPhase; }
+
+		// resets the conversion state, so this shouldn't be called while streaming
+		void setInterpolationQuality (const InterpolationQuality quality);
+		InterpolationQuality getInterpolationQuality() const { return m_InterpolationQuality; }
 
-		float getSourceToTargetSourceIncr() const { return m_SourceToTargetSourceIncr; }
+		// resets the conversion state and drift control, so this shouldn't be called while streaming
+		void setAsynchronous (const bool asynchronous);
+		bool isAsynchronous() const { return m_Asynchronous; }
+		// fillLevel is the number of target frames waiting to be consumed by the target
+		void updateFillLevel (const float fillLevel);
+		void updateMeasuredTargetRate (const float measuredTargetRate);
+		void setTargetFillLevel (const float targetFillLevel) { m_TargetFillLevel = targetFillLevel; }
+		float getTargetFillLevel() const { return m_TargetFillLevel; }
+		// how long the control loop takes to settle, in seconds
+		void setDriftControlTime (const float driftControlTime) { m_DriftControlTime = driftControlTime; }
+		float getDriftControlTime() const { return m_DriftControlTime; }
+		// as a fraction of the target rate, so 0.001 is 1000 ppm
+		void setMaxDrift (const float maxDrift) { m_MaxDrift = maxDrift; }
+		float getMaxDrift() const { return m_MaxDrift; }
+		// the current correction to the target rate as a fraction of the target rate
+		float getDrift() const { return m_Drift; }
+
+		float getSourceToTargetSourceIncr() const
+		{
+			return static_cast<float>( m_SourceToTargetSourceIncr )
+				+ ( static_cast<float>(m_SourceToTargetSourceIncrFrac) * m_SourceToTargetFracScale );
+		}
 		unsigned int getSourceToTargetTargetIncr() const { return m_SourceToTargetTargetIncr; }
-		float getTargetToSourceTargetIncr() const { return m_TargetToSourceTargetIncr; }
+		float getTargetToSourceTargetIncr() const
+		{
+			return static_cast<float>( m_TargetToSourceTargetIncr )
+				+ ( static_cast<float>(m_TargetToSourceTargetIncrFrac) * m_TargetToSourceFracScale );
+		}
 		unsigned int getTargetToSourceSourceIncr() const { return m_TargetToSourceSourceIncr; }
 
 		unsigned int getSourceRate() const { return m_SourceRate; }
 		unsigned int getTargetRate() const { return m_TargetRate; }
 		unsigned int getSourceBufferSize() const { return m_SourceBufferSize; }
+		unsigned int getAAFilterOrder() const { return m_AAFilterOrder; }
+		FilterWindow getAAFilterWindow() const { return m_AAFilterWindow; }
+		float getAAFilterKaiserBeta() const { return m_AAFilterKaiserBeta; }
+		FilterPhase getAAFilterPhase() const { return m_AAFilterPhase; }
 		float getFractionalTargetBufferSize() const { return m_TargetBufferSize; }
 
+		// the delay through each direction (interpolation plus the group delay of the filter that direction uses), in samples at
+		// the rate being converted to
+		float getSourceToTargetLatencySamples() const;
+		float getTargetToSourceLatencySamples() const;
+		// source to target and back again, in source samples, for plugin delay compensation
+		float getLatencySamples() const;
+
 		bool sourceToTargetIsUpsampling() const { return ( m_SourceRate < m_TargetRate ) ? true : false; }
 		bool targetToSourceIsUpsampling() const { return ( m_TargetRate < m_SourceRate ) ? true : false; }
 
+		static constexpr unsigned int getNumChannels() { return numChannels; }
+
 	private:
 		unsigned int 	m_SourceRate;
 		unsigned int 	m_TargetRate;
 		unsigned int 	m_SourceBufferSize;
 		float 		m_TargetBufferSize; // this value is a float, since conversion from source rate to target rate can be fractional
-		float 		m_SourceToTargetSourceIncr; // fractional sample number of current source buffer during resampling
-		float 		m_SourceToTargetTargetIncr; // fractional sample number of current target buffer sample during resampling
-		float 		m_TargetToSourceTargetIncr; // fractional sample number of current target buffer during resampling
-		float 	 	m_TargetToSourceSourceIncr; // fractional sample number of current source buffer sample during resampling
 
-		std::vector<SType> 	m_TargetToSourceEmittedSamples; // samples generated by fractional target buffers may exceed buffer size
-		TType 			m_WorkingTargetBufferLastSample;
-		SType 			m_WorkingSourceBufferLastSample;
+		// positions are kept as an integer sample number plus an exact fraction, so they never drift over long streams
+		unsigned int 	m_SourceToTargetSourceIncr; // sample number of current source buffer during resampling
+		unsigned int 	m_SourceToTargetSourceIncrFrac; // fraction of a source sample, over m_SourceToTargetFracDenominator
+		unsigned int 	m_SourceToTargetTargetIncr; // sample number of current target buffer sample during resampling
+		int 		m_TargetToSourceTargetIncr; // sample number of current target buffer during resampling (-1 is the last buffer)
+		unsigned int 	m_TargetToSourceTargetIncrFrac; // fraction of a target sample, over m_TargetToSourceFracDenominator
+		unsigned int 	m_TargetToSourceSourceIncr; // sample number of current source buffer sample during resampling
+
+		// how far each position moves per sample produced, using the rates divided by their greatest common divisor
+		unsigned int 	m_SourceToTargetStep;
+		unsigned int 	m_SourceToTargetStepFrac;
+		unsigned int 	m_SourceToTargetFracDenominator;
+		float 		m_SourceToTargetFracScale; // 1 / m_SourceToTargetFracDenominator
+		unsigned int 	m_TargetToSourceStep;
+		unsigned int 	m_TargetToSourceStepFrac;
+		unsigned int 	m_TargetToSourceFracDenominator;
+		float 		m_TargetToSourceFracScale; // 1 / m_TargetToSourceFracDenominator
+
+		bool 		m_Asynchronous;
+		float 		m_Drift; // the correction currently applied to the target rate
+		float 		m_MaxDrift;
+		float 		m_DriftControlTime;
+		float 		m_MeasuredDrift; // smoothed drift from updateMeasuredTargetRate
+		float 		m_FillLevelDrift; // output of the fill level control loop
+		float 		m_FillLevelErrorIntegral;
+		float 		m_TargetFillLevel;
+		float 		m_SmoothedFillLevel;
+		bool 		m_FillLevelIsValid;
 
-		AntiAliasingFilter<SType> m_SourceToTargetDownsamplingAAFilter;
-		AntiAliasingFilter<TType> m_SourceToTargetUpsamplingAAFilter;
-		AntiAliasingFilter<TType> m_TargetToSourceDownsamplingAAFilter;
-		AntiAliasingFilter<SType> m_TargetToSourceUpsamplingAAFilter;
+		// frames generated by fractional target buffers may exceed buffer size, so they're carried over to the next buffer in a
+		// ring that's only allocated when the rates or buffer size change
+		std::vector<SType> 	m_TargetToSourceCarry;
+		unsigned int 		m_TargetToSourceCarryFrames;
+		unsigned int 		m_TargetToSourceCarryStart; // in frames
+		unsigned int 		m_TargetToSourceCarryCount; // in frames
+
+		InterpolationQuality 	m_InterpolationQuality;
+		unsigned int 		m_HistoryLength; // the number of frames from the previous buffer that the interpolation needs
+		// the end of the previous buffer followed by the current buffer (interleaved), so the interpolation points are always
+		// contiguous
+		std::vector<float> 	m_SourceWorkingBuffer;
+		std::vector<float> 	m_TargetWorkingBuffer;
+		// SRC_SINC_PHASES + 1 rows of SRC_SINC_TAPS coefficients, only calculated in sinc mode
+		std::vector<float> 	m_SourceToTargetSincTable;
+		std::vector<float> 	m_TargetToSourceSincTable;
+
+		unsigned int 		m_AAFilterOrder;
+		FilterWindow 		m_AAFilterWindow;
+		float 			m_AAFilterKaiserBeta;
+		FilterPhase 		m_AAFilterPhase;
+
+		// one filter per channel, the coefficients are shared through the coefficient cache
+		std::vector<AntiAliasingFilter<SType>> m_SourceToTargetDownsamplingAAFilters;
+		std::vector<AntiAliasingFilter<TType>> m_SourceToTargetUpsamplingAAFilters;
+		std::vector<AntiAliasingFilter<TType>> m_TargetToSourceDownsamplingAAFilters;
+		std::vector<AntiAliasingFilter<SType>> m_TargetToSourceUpsamplingAAFilters;
 
 		constexpr TType convertSourceToTargetType (SType sourceType);
 		constexpr SType convertTargetToSourceType (TType targetType);
@@ -76,6 +250,72 @@ class SampleRateConverter
 		constexpr SType getSourceZeroPoint();
 
 		float getTargetBufferSizePerSourceBuffer() const;
+		void calculatePhaseSteps();
+		void calculateAsynchronousPhaseSteps();
+		void applyDrift();
+		void resetDriftControl();
+		void calculateSincTables();
+		void resetPhase();
+
+		template <typename Index>
+		static inline void advancePhase (Index& position, unsigned int& positionFrac, const unsigned int step,
+							const unsigned int stepFrac, const unsigned int fracDenominator)
+		{
+			position += step;
+			positionFrac += stepFrac;
+			if ( positionFrac >= fracDenominator )
+			{
+				positionFrac -= fracDenominator;
+				position++;
+			}
+		}
+		// the output falls between the middle two of getInterpolationPoints(quality) points, weights has room for all of them
+		template <InterpolationQuality quality>
+		static void calculateWeights (const float fraction, const std::vector<float>& sincTable, float* const weights);
+		// points holds numPoints interleaved frames, frame gets the weighted sum of each channel
+		template <unsigned int numPoints>
+		static inline void applyWeights (const float* const points, const float* const weights, float* const frame);
+
+		// one direction of an offline conversion, so both directions share the chunking
+		template <typename InType, typename OutType>
+		struct OfflineConversion
+		{
+			const InType* 		input;
+			unsigned int 		numInputFrames;
+			OutType* 		output;
+			unsigned int 		numOutputFrames;
+			// output frame n falls n * inputRateReduced / outputRateReduced frames into the input
+			unsigned int 		inputRateReduced;
+			unsigned int 		outputRateReduced;
+			const std::vector<float>* sincTable;
+			InType 			inputZeroPoint;
+			OutType 		(*convert)(InType);
+			// when downsampling the input is filtered before the conversion, when upsampling the output is filtered after
+			bool 			usePreFilter;
+			float 			preFilterCutoff;
+			unsigned int 		preFilterRate;
+			bool 			usePostFilter;
+			float 			postFilterCutoff;
+			unsigned int 		postFilterRate;
+		};
+		template <typename InType, typename OutType>
+		unsigned int convertOffline (const OfflineConversion<InType, OutType>& conversion, const unsigned int numThreads) const;
+		// converts output frames firstFrame to lastFrame, the scratch buffers are reused between chunks
+		template <InterpolationQuality quality, typename InType, typename OutType>
+		void convertOfflineChunk (const OfflineConversion<InType, OutType>& conversion, const unsigned int firstFrame,
+						const unsigned int lastFrame, std::vector<InType>& inputScratch, std::vector<float>& pointScratch,
+						std::vector<OutType>& outputScratch) const;
+
+		// the interpolation is the same for either ratio, so each direction's upsampling and downsampling share these
+		unsigned int convertFromSourceToTarget (const SType* const sourceBuffer, TType* const targetBuffer);
+		unsigned int convertFromTargetToSource (const TType* const targetBuffer, const unsigned int targetBufferSize,
+								SType* const sourceBuffer);
+		// the quality is chosen once per buffer instead of once per sample
+		template <InterpolationQuality quality>
+		unsigned int convertFromSourceToTargetWithQuality (const SType* const sourceBuffer, TType* const targetBuffer);
+		template <InterpolationQuality quality>
+		unsigned int convertFromTargetToSourceWithQuality (const TType* const targetBuffer, const unsigned int targetBufferSize,
+									SType* const sourceBuffer);
 };
 
 #endif // SAMPLERATECONVERTER_HPP
@@ -0,0 +1,65 @@
+#ifndef SELECTABLERESPONSE_HPP
+#define SELECTABLERESPONSE_HPP
+
+/***********************************************************************
+ * A SelectableResponse is a linear or exponential response that can be
+ * switched between at runtime, for example from a UI. Both responses are
+ * held by value and picked with a switch, so unlike going through an
+ * IResponse pointer the compiler can still inline them. The exponential
+ * slope is kept while the linear response is selected.
+***********************************************************************/
+
+#include "IResponse.hpp"
+#include "LinearResponse.hpp"
+#include "ExponentialResponse.hpp"
+
+enum class ResponseType : unsigned int
+{
+	LINEAR,
+	EXPONENTIAL
+};
+
+class SelectableResponse final : public IResponse
+{
+	public:
+		SelectableResponse (const ResponseType type = ResponseType::LINEAR, const float slope = 2.0f);
+		~SelectableResponse() override;
+
+		inline float response (const float value, const float minValue, const float maxValue) const override
+		{
+			switch ( m_ResponseType )
+			{
+				case ResponseType::EXPONENTIAL:
+					return m_ExponentialResponse.response( value, minValue, maxValue );
+				case ResponseType::LINEAR:
+				default:
+					return m_LinearResponse.response( value, minValue, maxValue );
+			}
+		}
+
+		inline bool getStepCoefficients (const float increment, const float minValue, const float maxValue,
+							float& multiplier, float& offset) const override
+		{
+			switch ( m_ResponseType )
+			{
+				case ResponseType::EXPONENTIAL:
+					return m_ExponentialResponse.getStepCoefficients( increment, minValue, maxValue, multiplier, offset );
+				case ResponseType::LINEAR:
+				default:
+					return m_LinearResponse.getStepCoefficients( increment, minValue, maxValue, multiplier, offset );
+			}
+		}
+
+		void setSlope (const float slope) override { m_ExponentialResponse.setSlope( slope ); }
+		float getSlope() override { return m_ExponentialResponse.getSlope(); }
+
+		void setResponseType (const ResponseType type) { m_ResponseType = type; }
+		ResponseType getResponseType() const { return m_ResponseType; }
+
+	private:
+		ResponseType 		m_ResponseType;
+		LinearResponse 		m_LinearResponse;
+		ExponentialResponse 	m_ExponentialResponse;
+};
+
+#endif // SELECTABLERESPONSE_HPP
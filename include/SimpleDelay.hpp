@@ -23,7 +23,7 @@ class SimpleDelay : public IBufferCallback<T>
 
 		void setDelayLength (unsigned int delayLength); // must be within maximum delay length defined in constructor
 
-		void call (T* writeBuffer) override;
+		void process (T* writeBuffer, unsigned int numSamples) override;
 
 	private:
 		unsigned int 	m_DelayLength;
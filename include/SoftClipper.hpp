@@ -63,7 +63,7 @@ class SoftClipper : public IBufferCallback<T>
 			return sampleVal;
 		}
 
-		void call (T* writeBuffer) override;
+		void process (T* writeBuffer, unsigned int numSamples) override;
 
 	private:
 };
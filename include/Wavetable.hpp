@@ -0,0 +1,63 @@
+#ifndef WAVETABLE_HPP
+#define WAVETABLE_HPP
+
+/*******************************************************************************
+ * A Wavetable holds a single cycle of a waveform, which is read at a phase
+ * from 0 to 1 with linear interpolation. The table size needs to be a power
+ * of 2 so the phase can wrap with a mask, and a guard point after the end of
+ * the cycle means the interpolation never has to wrap.
+ *
+ * Sine tables are shared by every oscillator that uses the same size, so
+ * getSineTable builds a table the first time a size is requested and hands
+ * out the same one after that. It allocates and locks, so it should be called
+ * off the audio thread. Sine tables are never freed, so the oscillators keep
+ * plain pointers to them.
+ *
+ * Error bounds for sine tables: linearly interpolating a sine with N points
+ * per cycle is off by at most (pi / N)^2 / 2, plus up to 1e-7 of float
+ * rounding, which getSineTableMaxError returns:
+ *
+ * 	  256 points: 7.5e-5 (-82dB)
+ * 	 1024 points: 4.8e-6 (-106dB)
+ * 	 4096 points: 3.9e-7 (-128dB)
+ *
+ * Past 4096 points the float rounding dominates.
+ *
+ * Other tables aren't band-limited, so any of their harmonics that are above
+ * the nyquist frequency at the frequency they're played at will alias.
+*******************************************************************************/
+
+#include <memory>
+#include <vector>
+
+constexpr unsigned int DEFAULT_SINE_TABLE_SIZE = 1024;
+constexpr float SINE_TABLE_ROUNDING_ERROR = 1e-7f; // from the table values, the position and the interpolation all being floats
+
+class Wavetable
+{
+	public:
+		// cycle holds size samples, where size is a power of 2
+		Wavetable (const float* const cycle, const unsigned int size);
+
+		inline float lookup (const float phase) const
+		{
+			const float position = phase * m_SizeFloat;
+			const unsigned int index = static_cast<unsigned int>( position );
+			const float fraction = position - static_cast<float>( index );
+			const float* const points = &m_Table[index & m_Mask];
+
+			return points[0] + ( (points[1] - points[0]) * fraction );
+		}
+
+		unsigned int getSize() const { return m_Mask + 1; }
+
+		static std::shared_ptr<const Wavetable> getSineTable (const unsigned int size = DEFAULT_SINE_TABLE_SIZE);
+		static float getSineTableMaxError (const unsigned int size);
+
+	private:
+		std::vector<float> 	m_Table; // the cycle followed by a copy of its first sample
+		unsigned int 		m_Mask;
+		float 			m_SizeFloat;
+};
+
+#endif // WAVETABLE_HPP
@@ -3,14 +3,16 @@
 #include "AudioConstants.hpp"
 #include "LinearResponse.hpp"
 #include "ExponentialResponse.hpp"
+#include "SelectableResponse.hpp"
+#include "TabulatedResponse.hpp"
 #include <algorithm>
 #include <cmath>
 #include <limits>
 
 template <typename Response>
 ADSREnvelopeGenerator<Response>::ADSREnvelopeGenerator (const float atkSec, const float decSec, const float susLvl,
-					const float relSec, Response* atkResponse, Response* decResponse,
-					Response* relResponse) :
+					const float relSec, const Response& atkResponse, const Response& decResponse,
+					const Response& relResponse) :
 	m_Attack( 0.0f ),
 	m_AttackSecs( atkSec ),
 	m_Decay( 0.0f ),
@@ -21,12 +23,13 @@ ADSREnvelopeGenerator<Response>::ADSREnvelopeGenerator (const float atkSec, cons
 	m_ReleaseSecs( relSec ),
 	m_Stage( 0 ),
 	m_CurrentLvl( 0.0f ),
+	m_JustEnteredRelease( false ),
 	m_AttackResponse( atkResponse ),
 	m_DecayResponse( decResponse ),
 	m_ReleaseResponse( relResponse )
 {
 	// setup the increment values in the order they're needed
-	this->setAttack( m_AttackSecs, m_AttackResponse->getSlope() );
+	this->setAttack( m_AttackSecs, m_AttackResponse.getSlope() );
 	this->setSustain( susLvl ); // setting sustain level also sets decay and release
 
 	// if atkSec, or any other are = to 0.0f, m_Attack will be inf, so we fix that
@@ -48,12 +51,12 @@ ADSREnvelopeGenerator<Response>::~ADSREnvelopeGenerator()
 template <typename Response>
 float ADSREnvelopeGenerator<Response>::nextValue()
 {
-	m_SustainAtResponse = m_ReleaseResponse->response( m_Sustain, 0.0f, 1.0f );
+	m_SustainAtResponse = m_ReleaseResponse.response( m_Sustain, 0.0f, 1.0f );
 	float output = m_SustainAtResponse;
 
 	if ( m_Stage == ATTACK )
 	{
-		output = m_AttackResponse->response( m_CurrentLvl, 0.0f, 1.0f );
+		output = m_AttackResponse.response( m_CurrentLvl, 0.0f, 1.0f );
 		m_CurrentLvl += m_Attack;
 		if ( m_CurrentLvl > 1.0f )
 		{
@@ -64,7 +67,7 @@ float ADSREnvelopeGenerator<Response>::nextValue()
 
 	if ( m_Stage == DECAY )
 	{
-		output = m_DecayResponse->response( m_CurrentLvl, 0.0f, 1.0f );
+		output = m_DecayResponse.response( m_CurrentLvl, 0.0f, 1.0f );
 		m_CurrentLvl -= m_Decay;
 		if ( output < m_SustainAtResponse )
 		{
@@ -80,7 +83,7 @@ float ADSREnvelopeGenerator<Response>::nextValue()
 		{
 			m_JustEnteredRelease = true;
 			// since release depends on m_CurrentLvl, we need to set it again as soon as we reach the release stage
-			this->setRelease( m_ReleaseSecs, m_ReleaseResponse->getSlope() );
+			this->setRelease( m_ReleaseSecs, m_ReleaseResponse.getSlope() );
 		}
 
 		if ( m_CurrentLvl <= 0.0f )
@@ -91,13 +94,112 @@ float ADSREnvelopeGenerator<Response>::nextValue()
 		else
 		{
 			m_CurrentLvl -= m_Release;
-			output = m_ReleaseResponse->response( m_CurrentLvl, 0.0f, 1.0f );
+			output = m_ReleaseResponse.response( m_CurrentLvl, 0.0f, 1.0f );
 		}
 	}
 
 	return output;
 }
 
+template <typename Response>
+void ADSREnvelopeGenerator<Response>::render (float* out, unsigned int numValues)
+{
+	// the same stages as nextValue, but each one runs for as long as it can in one go
+	m_SustainAtResponse = m_ReleaseResponse.response( m_Sustain, 0.0f, 1.0f );
+	unsigned int value = 0;
+
+	while ( value < numValues )
+	{
+		if ( m_Stage == ATTACK )
+		{
+			// the sample that takes the level past 1 is rendered by the decay stage
+			if ( this->renderStage<ATTACK>(out, numValues, value) )
+			{
+				m_CurrentLvl = 1.0f;
+				m_Stage++;
+			}
+		}
+		else if ( m_Stage == DECAY )
+		{
+			if ( this->renderStage<DECAY>(out, numValues, value) )
+			{
+				out[value] = m_SustainAtResponse;
+				value++;
+				m_CurrentLvl = m_Sustain;
+				m_Stage++;
+			}
+		}
+		else if ( m_Stage == SUSTAIN )
+		{
+			std::fill( out + value, out + numValues, m_SustainAtResponse );
+			value = numValues;
+		}
+		else // RELEASE
+		{
+			if ( !m_JustEnteredRelease )
+			{
+				m_JustEnteredRelease = true;
+				// since release depends on m_CurrentLvl, we need to set it again as soon as we reach the release stage
+				this->setRelease( m_ReleaseSecs, m_ReleaseResponse.getSlope() );
+			}
+
+			if ( this->renderStage<RELEASE>(out, numValues, value) )
+			{
+				m_CurrentLvl = 0.0f;
+				std::fill( out + value, out + numValues, 0.0f );
+				value = numValues;
+			}
+		}
+	}
+}
+
+// renders the stage from value until numValues or until the stage ends, and returns whether it ended. The response is
+// called once for the level the stage starts at, and after that it's stepped with the coefficients the response gives
+// for the increment, or called again for each sample if the response can't be stepped
+template <typename Response>
+template <unsigned int stage>
+inline bool ADSREnvelopeGenerator<Response>::renderStage (float* out, unsigned int numValues, unsigned int& value)
+{
+	const Response& response = ( stage == ATTACK ) ? m_AttackResponse : ( stage == DECAY ) ? m_DecayResponse
+													: m_ReleaseResponse;
+	const float step = ( stage == ATTACK ) ? m_Attack : ( stage == DECAY ) ? -m_Decay : -m_Release;
+	float multiplier = 1.0f;
+	float offset = 0.0f;
+	const bool canStep = response.getStepCoefficients( step, 0.0f, 1.0f, multiplier, offset );
+	float lvl = m_CurrentLvl;
+	float output = response.response( lvl, 0.0f, 1.0f );
+	bool ended = false;
+
+	for ( ; value < numValues; value++ )
+	{
+		// the stage ends in the same place nextValue would end it
+		if ( stage == ATTACK )
+		{
+			ended = ( lvl + step > 1.0f );
+		}
+		else if ( stage == DECAY )
+		{
+			ended = ( output < m_SustainAtResponse );
+		}
+		else
+		{
+			ended = ( lvl <= 0.0f );
+		}
+
+		if ( ended ) break;
+
+		// release steps the level before its sample is rendered, attack and decay step it after
+		if ( stage != RELEASE ) out[value] = output;
+		lvl += step;
+		output = ( canStep ) ? ( output * multiplier ) + offset : response.response( lvl, 0.0f, 1.0f );
+		if ( stage == RELEASE ) out[value] = output;
+	}
+
+	m_CurrentLvl = lvl;
+
+	return ended;
+}
+
 template <typename Response>
 float ADSREnvelopeGenerator<Response>::currentValue()
 {
@@ -133,19 +235,19 @@ void ADSREnvelopeGenerator<Response>::onKeyEvent (const KeyEvent& keyEvent)
 }
 
 template <typename Response>
-void ADSREnvelopeGenerator<Response>::setAttackResponse (Response* response)
+void ADSREnvelopeGenerator<Response>::setAttackResponse (const Response& response)
 {
 	m_AttackResponse = response;
 }
 
 template <typename Response>
-void ADSREnvelopeGenerator<Response>::setDecayResponse (Response* response)
+void ADSREnvelopeGenerator<Response>::setDecayResponse (const Response& response)
 {
 	m_DecayResponse = response;
 }
 
 template <typename Response>
-void ADSREnvelopeGenerator<Response>::setReleaseResponse (Response* response)
+void ADSREnvelopeGenerator<Response>::setReleaseResponse (const Response& response)
 {
 	m_ReleaseResponse = response;
 }
@@ -155,7 +257,7 @@ void ADSREnvelopeGenerator<Response>::setAttack (float seconds, float expo)
 {
 	m_AttackSecs = seconds;
 	m_Attack = (1.0f / SAMPLE_RATE) / seconds;
-	m_AttackResponse->setSlope( expo );
+	m_AttackResponse.setSlope( expo );
 
 	if ( m_AttackSecs == 0.0f || m_Attack == std::numeric_limits<float>::infinity() || std::isnan(m_Attack) )
 		{ m_Attack = std::numeric_limits<float>::max(); }
@@ -166,7 +268,7 @@ void ADSREnvelopeGenerator<Response>::setDecay (float seconds, float expo)
 {
 	m_DecaySecs = seconds;
 	m_Decay = ( (1.0f - m_SustainAtResponse) / SAMPLE_RATE ) / seconds;
-	m_DecayResponse->setSlope( expo );
+	m_DecayResponse.setSlope( expo );
 
 	if ( m_DecaySecs == 0.0f || m_Decay == std::numeric_limits<float>::infinity() || std::isnan(m_Decay) )
 		{ m_Decay = std::numeric_limits<float>::max(); }
@@ -176,10 +278,10 @@ template <typename Response>
 void ADSREnvelopeGenerator<Response>::setSustain (float lvl)
 {
 	m_Sustain = lvl;
-	m_SustainAtResponse = m_ReleaseResponse->response( m_Sustain, 0.0f, 1.0f );
+	m_SustainAtResponse = m_ReleaseResponse.response( m_Sustain, 0.0f, 1.0f );
 
 	// since decay depends on sustain at response
-	setDecay( m_DecaySecs, m_DecayResponse->getSlope() );
+	setDecay( m_DecaySecs, m_DecayResponse.getSlope() );
 }
 
 template <typename Response>
@@ -187,7 +289,7 @@ void ADSREnvelopeGenerator<Response>::setRelease (float seconds, float expo)
 {
 	m_ReleaseSecs = seconds;
 	m_Release = (m_CurrentLvl / SAMPLE_RATE) / seconds;
-	m_ReleaseResponse->setSlope( expo );
+	m_ReleaseResponse.setSlope( expo );
 
 	if ( m_ReleaseSecs == 0.0f || m_Release == std::numeric_limits<float>::infinity() || std::isnan(m_Release) )
 		{ m_Release = std::numeric_limits<float>::max(); }
@@ -220,21 +322,24 @@ float ADSREnvelopeGenerator<Response>::getRelease()
 template <typename Response>
 float ADSREnvelopeGenerator<Response>::getAttackExpo()
 {
-	return m_AttackResponse->getSlope();
+	return m_AttackResponse.getSlope();
 }
 
 template <typename Response>
 float ADSREnvelopeGenerator<Response>::getDecayExpo()
 {
-	return m_DecayResponse->getSlope();
+	return m_DecayResponse.getSlope();
 }
 
 template <typename Response>
 float ADSREnvelopeGenerator<Response>::getReleaseExpo()
 {
-	return m_ReleaseResponse->getSlope();
+	return m_ReleaseResponse.getSlope();
 }
 
 // avoid linker errors
 template class ADSREnvelopeGenerator<LinearResponse>;
 template class ADSREnvelopeGenerator<ExponentialResponse>;
+template class ADSREnvelopeGenerator<SelectableResponse>;
+template class ADSREnvelopeGenerator<TabulatedResponse<ExponentialResponse>>;
+template class ADSREnvelopeGenerator<TabulatedResponse<SelectableResponse>>;
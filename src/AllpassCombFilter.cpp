@@ -37,9 +37,9 @@ void AllpassCombFilter<T>::setFeedbackGain (float feedbackGain)
 }
 
 template <typename T>
-void AllpassCombFilter<T>::call (T* writeBuffer)
+void AllpassCombFilter<T>::process (T* writeBuffer, unsigned int numSamples)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		writeBuffer[sample] = this->processSample( writeBuffer[sample] );
 	}
@@ -47,9 +47,15 @@ void AllpassCombFilter<T>::call (T* writeBuffer)
 
 template <typename T>
 void AllpassCombFilter<T>::call (T* writeBuffer, unsigned int numModSamples, float* modSource)
+{
+	this->process( writeBuffer, ABUFFER_SIZE, numModSamples, modSource );
+}
+
+template <typename T>
+void AllpassCombFilter<T>::process (T* writeBuffer, unsigned int numSamples, unsigned int numModSamples, float* modSource)
 {
 	unsigned int unmodulatedSamples = m_DelayLength - numModSamples;
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		writeBuffer[sample] = this->processSample( writeBuffer[sample] );
 		this->setDelayLength( unmodulatedSamples + static_cast<unsigned int>(numModSamples * modSource[sample]) );
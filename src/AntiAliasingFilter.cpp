@@ -1,82 +1,198 @@
 #include "AntiAliasingFilter.hpp"
 
+#include "FIRKernels.hpp"
+
 #define _USE_MATH_DEFINES
 
 #include <stdint.h>
 #include <cmath>
+#include <algorithm>
+#include <complex>
+#include <map>
+#include <mutex>
+#include <tuple>
 
-template <typename T>
-AntiAliasingFilter<T>::AntiAliasingFilter (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder) :
-	m_CutoffFreq( cutoffFreq ),
-	m_SampleRate( sampleRate ),
-	m_FilterOrder( filterOrder ),
-	m_Coefficients( calculateCoefficients() ),
-	m_WorkingBuffer( filterOrder ),
-	m_WorkingBufferIncr( 0 )
+// cutoff, sample rate, filter order, window, kaiser beta (0 for other windows), phase
+using CoefficientCacheKey = std::tuple<float, unsigned int, unsigned int, FilterWindow, float, FilterPhase>;
+
+// the cepstrum of the design aliases unless the transforms are much longer than the filter
+constexpr unsigned int MIN_PHASE_FFT_OVERSAMPLING = 16;
+constexpr double MIN_PHASE_MAGNITUDE_FLOOR = 1e-7; // relative to the peak magnitude, so the stopband zeros don't blow up the log
+
+// the coefficients only depend on the filter design, so the cache is shared between all sample types
+static std::map<CoefficientCacheKey, std::shared_ptr<const std::vector<float>>> s_CoefficientCache;
+static std::mutex s_CoefficientCacheMutex;
+
+// zeroth order modified bessel function of the first kind, used by the kaiser window
+static double besselI0 (const double x)
 {
-	// fill working buffer with zero-values
-	for ( unsigned int sample = 0; sample < m_FilterOrder; sample++ )
+	const double halfXSquared = ( x * x ) / 4.0;
+	double term = 1.0;
+	double sum = 1.0;
+
+	for ( unsigned int k = 1; k < 64 && term > sum * 1e-12; k++ )
 	{
-		m_WorkingBuffer[sample] = static_cast<float>( getZeroPoint() );
+		term *= halfXSquared / ( static_cast<double>(k) * static_cast<double>(k) );
+		sum += term;
 	}
+
+	return sum;
 }
 
-template <typename T>
-void AntiAliasingFilter<T>::call (T* const buffer, const unsigned int bufferSize)
+float calculateFilterWindow (const FilterWindow window, const float kaiserBeta, const float position)
+{
+	const double phase = 2.0 * M_PI * static_cast<double>( position );
+
+	switch ( window )
+	{
+		case FilterWindow::BLACKMAN_HARRIS:
+			return static_cast<float>( 0.35875 - (0.48829 * cos(phase)) + (0.14128 * cos(2.0 * phase)) - (0.01168 * cos(3.0 * phase)) );
+		case FilterWindow::KAISER:
+		{
+			// goes from -1 to 1 across the filter
+			const double centeredPosition = ( 2.0 * static_cast<double>(position) ) - 1.0;
+			const double beta = static_cast<double>( kaiserBeta );
+			const double radicand = 1.0 - ( centeredPosition * centeredPosition );
+
+			return static_cast<float>( besselI0(beta * sqrt((radicand > 0.0) ? radicand : 0.0)) / besselI0(beta) );
+		}
+		case FilterWindow::HAMMING:
+		default:
+			return static_cast<float>( 0.54 - 0.46 * cos(phase) );
+	}
+}
+
+static float calculateWindow (const FilterWindow window, const float kaiserBeta, const unsigned int coeffNum, const unsigned int filterOrder)
 {
-	for ( unsigned int sample = 0; sample < bufferSize; sample++ )
+	if ( filterOrder < 2 )
 	{
-		// first put the input value in the working buffer (circular buffer)
-		m_WorkingBuffer[m_WorkingBufferIncr] = static_cast<float>( buffer[sample] );
+		return 1.0f;
+	}
+
+	return calculateFilterWindow( window, kaiserBeta, static_cast<float>(coeffNum) / (static_cast<float>(filterOrder) - 1.0f) );
+}
 
-		// apply filter using convolution
-		float output = static_cast<float>( getZeroPoint() );
-		for ( unsigned int coeffNum = 0; coeffNum < m_FilterOrder; coeffNum++)
+// in place radix-2 fft, the size of data needs to be a power of 2
+static void fft (std::vector<std::complex<double>>& data, const bool inverse)
+{
+	const unsigned int size = data.size();
+
+	// bit reversed reordering
+	for ( unsigned int index = 1, reversed = 0; index < size; index++ )
+	{
+		unsigned int bit = size >> 1;
+		for ( ; reversed & bit; bit >>= 1 )
 		{
-			// the index moves backwords (convolution)
-			unsigned int index = ( (m_WorkingBufferIncr + m_FilterOrder) - coeffNum ) % m_FilterOrder;
+			reversed ^= bit;
+		}
+		reversed ^= bit;
 
-			output += m_WorkingBuffer[index] * m_Coefficients[coeffNum];
+		if ( index < reversed )
+		{
+			std::swap( data[index], data[reversed] );
 		}
+	}
 
-		buffer[sample] = static_cast<T>( output );
-		m_WorkingBufferIncr = ( m_WorkingBufferIncr + 1 ) % m_FilterOrder;
+	for ( unsigned int length = 2; length <= size; length *= 2 )
+	{
+		const double angle = 2.0 * M_PI / static_cast<double>( length ) * ( (inverse) ? 1.0 : -1.0 );
+		const std::complex<double> rotation( cos(angle), sin(angle) );
+
+		for ( unsigned int start = 0; start < size; start += length )
+		{
+			std::complex<double> twiddle( 1.0, 0.0 );
+			for ( unsigned int offset = 0; offset < length / 2; offset++ )
+			{
+				const std::complex<double> even = data[start + offset];
+				const std::complex<double> odd = data[start + offset + (length / 2)] * twiddle;
+				data[start + offset] = even + odd;
+				data[start + offset + (length / 2)] = even - odd;
+				twiddle *= rotation;
+			}
+		}
+	}
+
+	if ( inverse )
+	{
+		for ( std::complex<double>& val : data )
+		{
+			val /= static_cast<double>( size );
+		}
 	}
 }
 
-template <typename T>
-void AntiAliasingFilter<T>::changeValues (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder)
+// replaces a design with the minimum phase filter with the same magnitude response, using the homomorphic (cepstrum) method
+static void convertToMinimumPhase (float* const filterCoeffs, const unsigned int filterOrder)
 {
-	// TODO this might cause crackling as is, which is fine for my current use-case, but for a realtime sample rate/bit crusher
-	// effect it would not. If I decide to create something like that in the future, the old working buffer values will need
-	// to be copied into the newWorkingBuffer
+	unsigned int fftSize = 1;
+	while ( fftSize < filterOrder * MIN_PHASE_FFT_OVERSAMPLING )
+	{
+		fftSize *= 2;
+	}
 
-	// set new values
-	m_CutoffFreq = cutoffFreq;
-	m_SampleRate = sampleRate;
-	m_FilterOrder = filterOrder;
-	m_Coefficients = calculateCoefficients();
-	std::vector<float> newWorkingBuffer( filterOrder );
-	m_WorkingBuffer = newWorkingBuffer;
-	m_WorkingBufferIncr = 0;
+	std::vector<std::complex<double>> spectrum( fftSize, std::complex<double>(0.0, 0.0) );
+	for ( unsigned int filterCoeff = 0; filterCoeff < filterOrder; filterCoeff++ )
+	{
+		spectrum[filterCoeff] = static_cast<double>( filterCoeffs[filterCoeff] );
+	}
+	fft( spectrum, false );
+
+	// the cepstrum is the inverse transform of the log magnitude
+	double peakMagnitude = 0.0;
+	for ( const std::complex<double>& val : spectrum )
+	{
+		peakMagnitude = std::max( peakMagnitude, std::abs(val) );
+	}
+	const double magnitudeFloor = peakMagnitude * MIN_PHASE_MAGNITUDE_FLOOR;
+	for ( std::complex<double>& val : spectrum )
+	{
+		val = std::log( std::max(std::abs(val), magnitudeFloor) );
+	}
+	fft( spectrum, true );
+
+	// folding the cepstrum onto its causal half keeps the magnitude but gives the phase that goes with it at minimum phase
+	for ( unsigned int index = 1; index < fftSize / 2; index++ )
+	{
+		spectrum[index] *= 2.0;
+		spectrum[index + (fftSize / 2)] = 0.0;
+	}
+	fft( spectrum, false );
+	for ( std::complex<double>& val : spectrum )
+	{
+		val = std::exp( val );
+	}
+	fft( spectrum, true );
 
-	// TODO don't want to do this when implementing the realtime version described in the above todo note
-	// fill working buffer with zero-values
-	for ( unsigned int sample = 0; sample < filterOrder; sample++ )
+	for ( unsigned int filterCoeff = 0; filterCoeff < filterOrder; filterCoeff++ )
 	{
-		m_WorkingBuffer[sample] = static_cast<float>( getZeroPoint() );
+		filterCoeffs[filterCoeff] = static_cast<float>( spectrum[filterCoeff].real() );
 	}
 }
 
-template <typename T>
-std::vector<float> AntiAliasingFilter<T>::calculateCoefficients()
+// the centroid of the impulse response, which is the group delay at DC
+static float calculateGroupDelay (const std::vector<float>& filterCoeffs)
+{
+	float weightedSum = 0.0f;
+	float sum = 0.0f;
+	for ( unsigned int filterCoeff = 0; filterCoeff < filterCoeffs.size(); filterCoeff++ )
+	{
+		weightedSum += static_cast<float>( filterCoeff ) * filterCoeffs[filterCoeff];
+		sum += filterCoeffs[filterCoeff];
+	}
+
+	return ( sum != 0.0f ) ? weightedSum / sum : 0.0f;
+}
+
+// filterCoeffs needs room for filterOrder coefficients
+static void calculateCoefficients (float* const filterCoeffs, const float cutoffFreq, const unsigned int sampleRate,
+					const unsigned int filterOrder, const FilterWindow window, const float kaiserBeta,
+					const FilterPhase phase)
 {
-	std::vector<float> filterCoeffs( m_FilterOrder );
-	const float normalizedCutoff = m_CutoffFreq / static_cast<float>( m_SampleRate );
-	const unsigned int mid = ( m_FilterOrder - 1 ) / 2;
+	const float normalizedCutoff = cutoffFreq / static_cast<float>( sampleRate );
+	const unsigned int mid = ( filterOrder - 1 ) / 2;
 
 	// compute the sinc function coefficients
-	for ( unsigned int coeffNum = 0; coeffNum < m_FilterOrder; coeffNum++ )
+	for ( unsigned int coeffNum = 0; coeffNum < filterOrder; coeffNum++ )
 	{
 		const int normalizedIndex = static_cast<int>( coeffNum ) - static_cast<int>( mid );
 
@@ -91,35 +207,311 @@ std::vector<float> AntiAliasingFilter<T>::calculateCoefficients()
 		}
 	}
 
-	// apply the hamming window
-	for ( unsigned int filterCoeff = 0; filterCoeff < m_FilterOrder; filterCoeff++ )
+	// apply the window
+	for ( unsigned int filterCoeff = 0; filterCoeff < filterOrder; filterCoeff++ )
 	{
-		filterCoeffs[filterCoeff] *= 0.54f - 0.46f
-			* cos( (2.0f * M_PI * static_cast<float>(filterCoeff)) / (static_cast<float>(m_FilterOrder) - 1.0f) );
+		filterCoeffs[filterCoeff] *= calculateWindow( window, kaiserBeta, filterCoeff, filterOrder );
 	}
 
 	// normalize the coefficients
 	float sum = 0.0f;
-	for ( unsigned int filterCoeff = 0; filterCoeff < m_FilterOrder; filterCoeff++ )
+	for ( unsigned int filterCoeff = 0; filterCoeff < filterOrder; filterCoeff++ )
 	{
 		sum += filterCoeffs[filterCoeff];
 	}
 	while ( sum > 1.0f ) // we want there to be unity gain, or slight attentuation
 	{
-		for ( unsigned int filterCoeff = 0; filterCoeff < m_FilterOrder; filterCoeff++ )
+		for ( unsigned int filterCoeff = 0; filterCoeff < filterOrder; filterCoeff++ )
 		{
 			filterCoeffs[filterCoeff] /= sum;
 		}
 		sum = 0.0f;
-		for ( unsigned int filterCoeff = 0; filterCoeff < m_FilterOrder; filterCoeff++ )
+		for ( unsigned int filterCoeff = 0; filterCoeff < filterOrder; filterCoeff++ )
 		{
 			sum += filterCoeffs[filterCoeff];
 		}
+	}
+
+	// the magnitude response (and so the gain) is kept, so this can be done after normalizing
+	if ( phase == FilterPhase::MINIMUM && filterOrder > 1 )
+	{
+		convertToMinimumPhase( filterCoeffs, filterOrder );
+	}
+}
+
+static CoefficientCacheKey getCoefficientCacheKey (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+							const FilterWindow window, const float kaiserBeta, const FilterPhase phase)
+{
+	return CoefficientCacheKey( cutoffFreq, sampleRate, filterOrder, window, (window == FilterWindow::KAISER) ? kaiserBeta : 0.0f,
+					phase );
+}
+
+template <typename T>
+AntiAliasingFilter<T>::AntiAliasingFilter (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+						const FilterWindow window, const float kaiserBeta, const FilterPhase phase) :
+	m_CutoffFreq( cutoffFreq ),
+	m_SampleRate( sampleRate ),
+	m_FilterOrder( filterOrder ),
+	m_MaxFilterOrder( filterOrder ),
+	m_Window( window ),
+	m_KaiserBeta( kaiserBeta ),
+	m_Phase( phase ),
+	m_Coefficients{ std::vector<float>(filterOrder), std::vector<float>(filterOrder) },
+	m_GroupDelay{ 0.0f, 0.0f },
+	m_ActiveCoefficients( 0 ),
+	m_CrossfadeLength( DEFAULT_AAF_CROSSFADE_LENGTH ),
+	m_CrossfadeSamplesLeft( 0 ),
+	m_WorkingBuffer( filterOrder * 2, static_cast<float>(getZeroPoint()) ),
+	m_WorkingBufferIncr( 0 ),
+	m_PolyphaseIndex( 0 ),
+	m_PolyphaseCoefficients(),
+	m_PolyphaseUpFactor{ 0, 0 },
+	m_PolyphaseBranchLength{ 0, 0 }
+{
+	// the constructor isn't expected to be realtime safe, so the design is cached for any filters that follow
+	cacheCoefficients( m_CutoffFreq, m_SampleRate, m_FilterOrder, m_Window, m_KaiserBeta, m_Phase );
+	this->setCoefficients( m_ActiveCoefficients );
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::call (T* const buffer, const unsigned int bufferSize, const unsigned int stride)
+{
+	for ( unsigned int sample = 0; sample < bufferSize * stride; sample += stride )
+	{
+		// first put the input value in the working buffer (circular buffer)
+		this->pushSample( static_cast<float>(buffer[sample]) );
+
+		// apply filter using convolution, the history runs from newest to oldest so it lines up with the coefficients
+		const std::vector<float>& coefficients = m_Coefficients[m_ActiveCoefficients];
+		float output = firDotProduct( &m_WorkingBuffer[m_WorkingBufferIncr], coefficients.data(), coefficients.size() );
+
+		if ( m_CrossfadeSamplesLeft > 0 )
+		{
+			const std::vector<float>& oldCoefficients = m_Coefficients[1 - m_ActiveCoefficients];
+			output = this->crossfade( output, firDotProduct(&m_WorkingBuffer[m_WorkingBufferIncr], oldCoefficients.data(),
+										oldCoefficients.size()) );
+		}
+
+		buffer[sample] = static_cast<T>( output );
+	}
+}
+
+template <typename T>
+unsigned int AntiAliasingFilter<T>::resample (const T* const inBuffer, const unsigned int inBufferSize, T* const outBuffer,
+						const unsigned int upFactor, const unsigned int downFactor)
+{
+	// each branch only sees every upFactor'th coefficient, so we make up the gain
+	const float branchGain = static_cast<float>( upFactor );
+	const unsigned int newSet = m_ActiveCoefficients;
+	const unsigned int oldSet = 1 - m_ActiveCoefficients;
+	const float* const polyphaseCoefficients = this->getPolyphaseCoefficients( newSet, upFactor );
+	const float* const oldPolyphaseCoefficients = ( m_CrossfadeSamplesLeft > 0 ) ? this->getPolyphaseCoefficients( oldSet, upFactor )
+												: nullptr;
+	unsigned int samplesWritten = 0;
+
+	for ( unsigned int sample = 0; sample < inBufferSize; sample++ )
+	{
+		// input samples are always put into the working buffer, even if no output uses them yet
+		this->pushSample( static_cast<float>(inBuffer[sample]) );
+
+		// compute only the outputs that fall between this input sample and the next
+		while ( m_PolyphaseIndex < upFactor )
+		{
+			float output = firDotProduct( &m_WorkingBuffer[m_WorkingBufferIncr],
+							&polyphaseCoefficients[m_PolyphaseIndex * m_PolyphaseBranchLength[newSet]],
+							m_PolyphaseBranchLength[newSet] );
+
+			if ( m_CrossfadeSamplesLeft > 0 )
+			{
+				output = this->crossfade( output, firDotProduct(&m_WorkingBuffer[m_WorkingBufferIncr],
+							&oldPolyphaseCoefficients[m_PolyphaseIndex * m_PolyphaseBranchLength[oldSet]],
+							m_PolyphaseBranchLength[oldSet]) );
+			}
+
+			outBuffer[samplesWritten] = static_cast<T>( output * branchGain );
+			samplesWritten++;
+
+			m_PolyphaseIndex += downFactor;
+		}
+
+		m_PolyphaseIndex -= upFactor;
+	}
+
+	return samplesWritten;
+}
+
+template <typename T>
+const float* AntiAliasingFilter<T>::getPolyphaseCoefficients (const unsigned int set, const unsigned int upFactor)
+{
+	if ( upFactor != m_PolyphaseUpFactor[set] )
+	{
+		// each branch takes every upFactor'th coefficient, zero-padded so that all branches are the same length
+		const std::vector<float>& coefficients = m_Coefficients[set];
+		const unsigned int filterOrder = coefficients.size();
+		const unsigned int branchLength = ( filterOrder + upFactor - 1 ) / upFactor;
+		m_PolyphaseUpFactor[set] = upFactor;
+		m_PolyphaseBranchLength[set] = branchLength;
+		m_PolyphaseCoefficients[set].assign( upFactor * branchLength, 0.0f );
+
+		for ( unsigned int coeffNum = 0; coeffNum < filterOrder; coeffNum++ )
+		{
+			const unsigned int branch = coeffNum % upFactor;
+			const unsigned int tap = coeffNum / upFactor;
+			m_PolyphaseCoefficients[set][(branch * branchLength) + tap] = coefficients[coeffNum];
+		}
+	}
+
+	return m_PolyphaseCoefficients[set].data();
+}
+
+template <typename T>
+unsigned int AntiAliasingFilter<T>::decimate (T* const buffer, const unsigned int bufferSize, const unsigned int factor)
+{
+	// outputs are never written ahead of the input being read, so this can be done in place
+	return this->resample( buffer, bufferSize, buffer, 1, factor );
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::interpolate (const T* const inBuffer, const unsigned int inBufferSize, T* const outBuffer,
+						const unsigned int factor)
+{
+	this->resample( inBuffer, inBufferSize, outBuffer, factor, 1 );
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::changeValues (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+						const FilterWindow window, const float kaiserBeta, const FilterPhase phase)
+{
+	if ( filterOrder > m_MaxFilterOrder )
+	{
+		this->reserve( filterOrder );
+	}
 
-		m_FilterOrder = m_FilterOrder % 41324234;
+	if ( m_CrossfadeSamplesLeft > 0 )
+	{
+		this->bakeCrossfade();
 	}
 
-	return filterCoeffs;
+	// set new values
+	m_CutoffFreq = cutoffFreq;
+	m_SampleRate = sampleRate;
+	m_FilterOrder = filterOrder;
+	m_Window = window;
+	m_KaiserBeta = kaiserBeta;
+	m_Phase = phase;
+
+	// the new coefficients go into the other set, which then fades in over the current set (or the baked mix of both)
+	m_ActiveCoefficients = 1 - m_ActiveCoefficients;
+	this->setCoefficients( m_ActiveCoefficients );
+	m_CrossfadeSamplesLeft = m_CrossfadeLength;
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::bakeCrossfade()
+{
+	// the same gain crossfade uses for the next sample, mixing the coefficients mixes the outputs since both sets
+	// filter the same history
+	const float newGain = 1.0f - ( static_cast<float>(m_CrossfadeSamplesLeft) / static_cast<float>(m_CrossfadeLength) );
+	std::vector<float>& coefficients = m_Coefficients[m_ActiveCoefficients];
+	const std::vector<float>& oldCoefficients = m_Coefficients[1 - m_ActiveCoefficients];
+
+	// the shorter set is padded with zeros, neither can be longer than the history so this doesn't allocate
+	const unsigned int filterOrder = std::max( coefficients.size(), oldCoefficients.size() );
+	coefficients.resize( filterOrder, 0.0f );
+	for ( unsigned int coeffNum = 0; coeffNum < filterOrder; coeffNum++ )
+	{
+		const float oldCoeff = ( coeffNum < oldCoefficients.size() ) ? oldCoefficients[coeffNum] : 0.0f;
+		coefficients[coeffNum] = oldCoeff + ( (coefficients[coeffNum] - oldCoeff) * newGain );
+	}
+
+	m_PolyphaseUpFactor[m_ActiveCoefficients] = 0;
+	m_GroupDelay[m_ActiveCoefficients] = calculateGroupDelay( coefficients );
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::reserve (const unsigned int maxFilterOrder)
+{
+	if ( maxFilterOrder <= m_MaxFilterOrder )
+	{
+		return;
+	}
+
+	// keep the newest samples of the history, anything older than that is silence
+	std::vector<float> newWorkingBuffer( maxFilterOrder * 2, static_cast<float>(getZeroPoint()) );
+	for ( unsigned int sample = 0; sample < m_MaxFilterOrder; sample++ )
+	{
+		const float sampleVal = m_WorkingBuffer[m_WorkingBufferIncr + sample];
+		newWorkingBuffer[sample] = sampleVal;
+		newWorkingBuffer[sample + maxFilterOrder] = sampleVal;
+	}
+	m_WorkingBuffer.swap( newWorkingBuffer );
+	m_WorkingBufferIncr = 0;
+	m_MaxFilterOrder = maxFilterOrder;
+
+	m_Coefficients[0].reserve( maxFilterOrder );
+	m_Coefficients[1].reserve( maxFilterOrder );
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::setCoefficients (const unsigned int set)
+{
+	std::vector<float>& coefficients = m_Coefficients[set];
+	// since the vector never shrinks its capacity this doesn't allocate unless the filter order has grown
+	coefficients.resize( m_FilterOrder );
+	m_PolyphaseUpFactor[set] = 0;
+
+	const CoefficientCacheKey key = getCoefficientCacheKey( m_CutoffFreq, m_SampleRate, m_FilterOrder, m_Window, m_KaiserBeta, m_Phase );
+
+	// if another thread is using the cache, we'd rather calculate the coefficients than wait
+	std::unique_lock<std::mutex> lock( s_CoefficientCacheMutex, std::try_to_lock );
+	bool isCached = false;
+	if ( lock.owns_lock() )
+	{
+		auto cachedCoeffs = s_CoefficientCache.find( key );
+		if ( cachedCoeffs != s_CoefficientCache.end() )
+		{
+			std::copy( cachedCoeffs->second->begin(), cachedCoeffs->second->end(), coefficients.begin() );
+			isCached = true;
+		}
+		lock.unlock();
+	}
+
+	if ( ! isCached )
+	{
+		calculateCoefficients( coefficients.data(), m_CutoffFreq, m_SampleRate, m_FilterOrder, m_Window, m_KaiserBeta, m_Phase );
+	}
+
+	m_GroupDelay[set] = calculateGroupDelay( coefficients );
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::cacheCoefficients (const float cutoffFreq, const unsigned int sampleRate, const unsigned int filterOrder,
+						const FilterWindow window, const float kaiserBeta, const FilterPhase phase)
+{
+	const CoefficientCacheKey key = getCoefficientCacheKey( cutoffFreq, sampleRate, filterOrder, window, kaiserBeta, phase );
+
+	std::lock_guard<std::mutex> lock( s_CoefficientCacheMutex );
+
+	if ( s_CoefficientCache.count(key) == 0 )
+	{
+		std::shared_ptr<std::vector<float>> filterCoeffs = std::make_shared<std::vector<float>>( filterOrder );
+		calculateCoefficients( filterCoeffs->data(), cutoffFreq, sampleRate, filterOrder, window, kaiserBeta, phase );
+		s_CoefficientCache.emplace( key, filterCoeffs );
+	}
+}
+
+template <typename T>
+void AntiAliasingFilter<T>::clearCoefficientCache()
+{
+	std::lock_guard<std::mutex> lock( s_CoefficientCacheMutex );
+	s_CoefficientCache.clear();
+}
+
+template <typename T>
+unsigned int AntiAliasingFilter<T>::getCoefficientCacheSize()
+{
+	std::lock_guard<std::mutex> lock( s_CoefficientCacheMutex );
+	return static_cast<unsigned int>( s_CoefficientCache.size() );
 }
 
 template <>
@@ -1,45 +1,61 @@
 #include "AudioBuffer.hpp"
 
 #include "AudioConstants.hpp"
+#include <algorithm>
 
 template <typename T>
-AudioBuffer<T, false>::AudioBuffer() :
-	m_Buffers{ 0 },
-	m_CurrentBuffer( m_Buffers ),
+AudioBuffer<T, false>::AudioBuffer (unsigned int numSamples, unsigned int numBlocks) :
+	m_NumSamples( 0 ),
+	m_NumBlocks( 0 ),
+	m_Buffers( nullptr ),
+	m_Ring(),
+	m_CurrentBuffer( nullptr ),
 	m_Pos( 0 ),
-	m_Callbacks(),
-	m_NextReadBlockFilled( true )
+	m_Callbacks()
 {
+	this->allocateBuffers( numSamples, numBlocks );
 }
 
 template <typename T>
 AudioBuffer<T, false>::AudioBuffer (const AudioBuffer& other) :
-	m_Buffers{ 0 },
+	m_NumSamples( 0 ),
+	m_NumBlocks( 0 ),
+	m_Buffers( nullptr ),
+	m_Ring(),
+	m_CurrentBuffer( nullptr ),
+	m_Pos( 0 ),
 	m_Callbacks()
 {
-	const T* bufferOther = other.getBuffer1();
-	for ( int sample = 0; sample < ABUFFER_SIZE * 2; sample++ )
+	this->allocateBuffers( other.getNumSamples(), other.getNumBlocks() );
+
+	const T* bufferOther = other.getBlock( 0 );
+	for ( unsigned int sample = 0; sample < m_NumSamples * m_NumBlocks; sample++ )
 		m_Buffers[sample] = bufferOther[sample];
 
-	for ( IBufferCallback<T, false>* bC : other.getCallbacks() )
-		m_Callbacks.insert(bC);
+	m_Callbacks = other.getCallbacks();
 }
 
 template <typename T>
 AudioBuffer<T, false>::~AudioBuffer()
 {
+	delete[] m_Buffers;
 }
 
 template <typename T>
 AudioBuffer<T, false>& AudioBuffer<T, false>::operator= (const AudioBuffer& other)
 {
-	const T* bufferOther = other.getBuffer1();
-	for ( int sample = 0; sample < ABUFFER_SIZE * 2; sample++ )
+	if ( this == &other )
+	{
+		return *this;
+	}
+
+	this->allocateBuffers( other.getNumSamples(), other.getNumBlocks() );
+
+	const T* bufferOther = other.getBlock( 0 );
+	for ( unsigned int sample = 0; sample < m_NumSamples * m_NumBlocks; sample++ )
 		m_Buffers[sample] = bufferOther[sample];
 
-	m_Callbacks.clear();
-	for ( IBufferCallback<T, false>* bC : other.getCallbacks() )
-		m_Callbacks.insert( bC );
+	m_Callbacks = other.getCallbacks();
 
 
 	return *this;
@@ -48,7 +64,25 @@ AudioBuffer<T, false>& AudioBuffer<T, false>::operator= (const AudioBuffer& othe
 template <typename T>
 unsigned int AudioBuffer<T, false>::getNumSamples() const
 {
-	return ABUFFER_SIZE;
+	return m_NumSamples;
+}
+
+template <typename T>
+void AudioBuffer<T, false>::setNumSamples (unsigned int numSamples)
+{
+	this->allocateBuffers( numSamples, m_NumBlocks );
+}
+
+template <typename T>
+unsigned int AudioBuffer<T, false>::getNumBlocks() const
+{
+	return m_NumBlocks;
+}
+
+template <typename T>
+void AudioBuffer<T, false>::setNumBlocks (unsigned int numBlocks)
+{
+	this->allocateBuffers( m_NumSamples, numBlocks );
 }
 
 template <typename T>
@@ -59,38 +93,72 @@ T AudioBuffer<T, false>::getNextSample (T sampleValToReadBuf)
 	m_CurrentBuffer[m_Pos] = sampleValToReadBuf;
 
 	m_Pos++;
-	if ( m_Pos == ABUFFER_SIZE )
+	if ( m_Pos == m_NumSamples )
 	{
 		m_Pos = 0;
 
-		m_NextReadBlockFilled = false;
-		m_CurrentBuffer = ( m_CurrentBuffer == m_Buffers ) ? &m_Buffers[ABUFFER_SIZE] : m_Buffers;
+		this->advanceReadBlock();
 	}
 
 	return retVal;
 }
 
+template <typename T>
+void AudioBuffer<T, false>::readBlock (T* dst, unsigned int numSamples, const T* sampleValsToReadBuf)
+{
+	while ( numSamples > 0 )
+	{
+		// copy up to the end of the current block at most
+		const unsigned int numToCopy = std::min( numSamples, m_NumSamples - m_Pos );
+		T* const readPtr = &m_CurrentBuffer[m_Pos];
+
+		readAndWriteBack( readPtr, dst, sampleValsToReadBuf, numToCopy );
+
+		dst += numToCopy;
+		sampleValsToReadBuf = ( sampleValsToReadBuf ) ? sampleValsToReadBuf + numToCopy : nullptr;
+		numSamples -= numToCopy;
+		m_Pos += numToCopy;
+
+		if ( m_Pos == m_NumSamples )
+		{
+			m_Pos = 0;
+
+			this->advanceReadBlock();
+		}
+	}
+}
+
 template <typename T>
 void AudioBuffer<T, false>::triggerCallbacksOnNextPoll (bool writeToBuffer1)
 {
-	m_CurrentBuffer = ( writeToBuffer1 ) ? m_Buffers : &m_Buffers[ABUFFER_SIZE];
-	m_NextReadBlockFilled = false;
+	// only the read block is considered filled, so the next poll fills every other block
+	const unsigned int readBlock = ( writeToBuffer1 ) ? 0 : 1;
+	m_Ring.startReadingAt( readBlock );
+	m_CurrentBuffer = &m_Buffers[readBlock * m_NumSamples];
 }
 
 template <typename T>
 void AudioBuffer<T, false>::pollToFillBuffers()
 {
-	if ( ! m_NextReadBlockFilled )
-	{
-		T* nextBuffer = ( m_CurrentBuffer == m_Buffers ) ? &m_Buffers[ABUFFER_SIZE] : m_Buffers;
+	this->fillFreeBlocks( [this] (T* writeBuffer, unsigned int numSamples)
+				{
+					for ( IBufferCallback<T, false>* callback : m_Callbacks )
+					{
+						callback->process( writeBuffer, numSamples );
+					}
+				} );
+}
 
-		for ( IBufferCallback<T, false>* callback : m_Callbacks )
-		{
-			callback->call( nextBuffer );
-		}
+template <typename T>
+unsigned int AudioBuffer<T, false>::getNextBlockToWrite() const
+{
+	return m_Ring.getNextWriteBlock();
+}
 
-		m_NextReadBlockFilled = true;
-	}
+template <typename T>
+const T* AudioBuffer<T, false>::getBlock (unsigned int block) const
+{
+	return &m_Buffers[block * m_NumSamples];
 }
 
 template <typename T>
@@ -108,11 +176,11 @@ const T* AudioBuffer<T, false>::getBuffer1() const
 template <typename T>
 const T* AudioBuffer<T, false>::getBuffer2() const
 {
-	return &m_Buffers[ABUFFER_SIZE];
+	return &m_Buffers[m_NumSamples];
 }
 
 template <typename T>
-const std::set<IBufferCallback<T, false>*>& AudioBuffer<T, false>::getCallbacks() const
+const std::vector<IBufferCallback<T, false>*>& AudioBuffer<T, false>::getCallbacks() const
 {
 	return m_Callbacks;
 }
@@ -120,18 +188,65 @@ const std::set<IBufferCallback<T, false>*>& AudioBuffer<T, false>::getCallbacks(
 template <typename T>
 void AudioBuffer<T, false>::registerCallback (IBufferCallback<T, false>* callback)
 {
-	if ( callback )
+	this->registerCallback( callback, m_Callbacks.size() );
+}
+
+template <typename T>
+void AudioBuffer<T, false>::registerCallback (IBufferCallback<T, false>* callback, unsigned int position)
+{
+	if ( callback && std::find(m_Callbacks.begin(), m_Callbacks.end(), callback) == m_Callbacks.end() )
 	{
-		m_Callbacks.insert(callback);
+		position = std::min( position, static_cast<unsigned int>(m_Callbacks.size()) );
+		m_Callbacks.insert( m_Callbacks.begin() + position, callback );
 	}
 }
 
+template <typename T>
+void AudioBuffer<T, false>::unregisterCallback (IBufferCallback<T, false>* callback)
+{
+	m_Callbacks.erase( std::remove(m_Callbacks.begin(), m_Callbacks.end(), callback), m_Callbacks.end() );
+}
+
+template <typename T>
+void AudioBuffer<T, false>::allocateBuffers (unsigned int numSamples, unsigned int numBlocks)
+{
+	if ( numBlocks < 2 )
+	{
+		numBlocks = 2;
+	}
+
+	if ( numSamples != m_NumSamples || numBlocks != m_NumBlocks )
+	{
+		delete[] m_Buffers;
+		m_NumSamples = numSamples;
+		m_NumBlocks = numBlocks;
+		m_Buffers = new T[m_NumSamples * m_NumBlocks]{ 0 };
+	}
+
+	this->resetCounts();
+}
+
+template <typename T>
+void AudioBuffer<T, false>::advanceReadBlock()
+{
+	m_CurrentBuffer = &m_Buffers[ m_Ring.advanceRead() * m_NumSamples ];
+}
+
+template <typename T>
+void AudioBuffer<T, false>::resetCounts()
+{
+	// the reading side starts on the first block with all other blocks considered filled
+	m_Ring.reset( m_NumBlocks );
+	m_CurrentBuffer = m_Buffers;
+	m_Pos = 0;
+}
+
 template <typename T>
 T* AudioBuffer<T, false>::getBuffer (bool writeBuffer)
 {
 	if ( writeBuffer )
 	{
-		return &m_Buffers[ABUFFER_SIZE];
+		return &m_Buffers[m_NumSamples];
 	}
 	else
 	{
@@ -140,56 +255,73 @@ T* AudioBuffer<T, false>::getBuffer (bool writeBuffer)
 }
 
 template <typename T>
-AudioBuffer<T, true>::AudioBuffer() :
-	m_BuffersL{ 0 },
-	m_BuffersR{ 0 },
-	m_CurrentBufferL( m_BuffersL ),
-	m_CurrentBufferR( m_BuffersR ),
+AudioBuffer<T, true>::AudioBuffer (unsigned int numSamples, unsigned int numBlocks) :
+	m_NumSamples( 0 ),
+	m_NumBlocks( 0 ),
+	m_BuffersL( nullptr ),
+	m_BuffersR( nullptr ),
+	m_Ring(),
+	m_CurrentBufferL( nullptr ),
+	m_CurrentBufferR( nullptr ),
 	m_PosL( 0 ),
 	m_PosR( 0 ),
-	m_Callbacks(),
-	m_NextReadBlockFilledL( true ),
-	m_NextReadBlockFilledR( true )
+	m_Callbacks()
 {
+	this->allocateBuffers( numSamples, numBlocks );
 }
 
 template <typename T>
 AudioBuffer<T, true>::AudioBuffer (const AudioBuffer& other) :
-	m_BuffersL{ 0 },
-	m_BuffersR{ 0 },
+	m_NumSamples( 0 ),
+	m_NumBlocks( 0 ),
+	m_BuffersL( nullptr ),
+	m_BuffersR( nullptr ),
+	m_Ring(),
+	m_CurrentBufferL( nullptr ),
+	m_CurrentBufferR( nullptr ),
+	m_PosL( 0 ),
+	m_PosR( 0 ),
 	m_Callbacks()
 {
-	const T* buffersLOther = other.getBufferL1();
-	for ( int sample = 0; sample < ABUFFER_SIZE * 2; sample++ )
+	this->allocateBuffers( other.getNumSamples(), other.getNumBlocks() );
+
+	const T* buffersLOther = other.getBlockL( 0 );
+	for ( unsigned int sample = 0; sample < m_NumSamples * m_NumBlocks; sample++ )
 		m_BuffersL[sample] = buffersLOther[sample];
 
-	const T* buffersROther = other.getBufferR1();
-	for ( int sample = 0; sample < ABUFFER_SIZE * 2; sample++ )
+	const T* buffersROther = other.getBlockR( 0 );
+	for ( unsigned int sample = 0; sample < m_NumSamples * m_NumBlocks; sample++ )
 		m_BuffersR[sample] = buffersROther[sample];
 
-	for ( IBufferCallback<T, false>* bC : other.getCallbacks() )
-		m_Callbacks.insert(bC);
+	m_Callbacks = other.getCallbacks();
 }
 
 template <typename T>
 AudioBuffer<T, true>::~AudioBuffer()
 {
+	delete[] m_BuffersL;
+	delete[] m_BuffersR;
 }
 
 template <typename T>
 AudioBuffer<T, true>& AudioBuffer<T, true>::operator= (const AudioBuffer& other)
 {
-	const T* buffersLOther = other.getBufferL1();
-	for ( int sample = 0; sample < ABUFFER_SIZE * 2; sample++ )
+	if ( this == &other )
+	{
+		return *this;
+	}
+
+	this->allocateBuffers( other.getNumSamples(), other.getNumBlocks() );
+
+	const T* buffersLOther = other.getBlockL( 0 );
+	for ( unsigned int sample = 0; sample < m_NumSamples * m_NumBlocks; sample++ )
 		m_BuffersL[sample] = buffersLOther[sample];
 
-	const T* buffersROther = other.getBufferR1();
-	for ( int sample = 0; sample < ABUFFER_SIZE * 2; sample++ )
+	const T* buffersROther = other.getBlockR( 0 );
+	for ( unsigned int sample = 0; sample < m_NumSamples * m_NumBlocks; sample++ )
 		m_BuffersR[sample] = buffersROther[sample];
 
-	m_Callbacks.clear();
-	for ( IBufferCallback<T, false>* bC : other.getCallbacks() )
-		m_Callbacks.insert( bC );
+	m_Callbacks = other.getCallbacks();
 
 
 	return *this;
@@ -198,7 +330,25 @@ AudioBuffer<T, true>& AudioBuffer<T, true>::operator= (const AudioBuffer& other)
 template <typename T>
 unsigned int AudioBuffer<T, true>::getNumSamples() const
 {
-	return ABUFFER_SIZE;
+	return m_NumSamples;
+}
+
+template <typename T>
+void AudioBuffer<T, true>::setNumSamples (unsigned int numSamples)
+{
+	this->allocateBuffers( numSamples, m_NumBlocks );
+}
+
+template <typename T>
+unsigned int AudioBuffer<T, true>::getNumBlocks() const
+{
+	return m_NumBlocks;
+}
+
+template <typename T>
+void AudioBuffer<T, true>::setNumBlocks (unsigned int numBlocks)
+{
+	this->allocateBuffers( m_NumSamples, numBlocks );
 }
 
 template <typename T>
@@ -209,12 +359,11 @@ T AudioBuffer<T, true>::getNextSampleL (T sampleValToReadBuf)
 	m_CurrentBufferL[m_PosL] = sampleValToReadBuf;
 
 	m_PosL++;
-	if ( m_PosL == ABUFFER_SIZE )
+	if ( m_PosL == m_NumSamples )
 	{
 		m_PosL = 0;
 
-		m_NextReadBlockFilledL = false;
-		m_CurrentBufferL = ( m_CurrentBufferL == m_BuffersL ) ? &m_BuffersL[ABUFFER_SIZE] : m_BuffersL;
+		this->advanceReadBlock( m_CurrentBufferL, 0, m_BuffersL );
 	}
 
 	return retVal;
@@ -228,44 +377,90 @@ T AudioBuffer<T, true>::getNextSampleR (T sampleValToReadBuf)
 	m_CurrentBufferR[m_PosR] = sampleValToReadBuf;
 
 	m_PosR++;
-	if ( m_PosR == ABUFFER_SIZE )
+	if ( m_PosR == m_NumSamples )
 	{
 		m_PosR = 0;
 
-		m_NextReadBlockFilledR = false;
-		m_CurrentBufferR = ( m_CurrentBufferR == m_BuffersR ) ? &m_BuffersR[ABUFFER_SIZE] : m_BuffersR;
+		this->advanceReadBlock( m_CurrentBufferR, 1, m_BuffersR );
 	}
 
 	return retVal;
 }
 
 template <typename T>
-void AudioBuffer<T, true>::triggerCallbacksOnNextPoll (bool writeToBuffer1)
+void AudioBuffer<T, true>::readBlock (T* dstL, T* dstR, unsigned int numSamples,
+					const T* sampleValsToReadBufL, const T* sampleValsToReadBufR)
 {
-	m_CurrentBufferL = ( writeToBuffer1 ) ? m_BuffersL : &m_BuffersL[ABUFFER_SIZE];
-	m_CurrentBufferR = ( writeToBuffer1 ) ? m_BuffersR : &m_BuffersR[ABUFFER_SIZE];
-	m_NextReadBlockFilledL = false;
-	m_NextReadBlockFilledR = false;
+	this->readChannelBlock( dstL, numSamples, sampleValsToReadBufL, m_CurrentBufferL, m_PosL, 0, m_BuffersL );
+	this->readChannelBlock( dstR, numSamples, sampleValsToReadBufR, m_CurrentBufferR, m_PosR, 1, m_BuffersR );
 }
 
 template <typename T>
-void AudioBuffer<T, true>::pollToFillBuffers()
+void AudioBuffer<T, true>::readChannelBlock (T* dst, unsigned int numSamples, const T* sampleValsToReadBuf,
+						T*& currentBuffer, unsigned int& pos, unsigned int reader, T* buffers)
 {
-	if ( ! m_NextReadBlockFilledL && ! m_NextReadBlockFilledR )
+	while ( numSamples > 0 )
 	{
-		T* nextBufferL = ( m_CurrentBufferL == m_BuffersL ) ? &m_BuffersL[ABUFFER_SIZE] : m_BuffersL;
-		T* nextBufferR = ( m_CurrentBufferR == m_BuffersR ) ? &m_BuffersR[ABUFFER_SIZE] : m_BuffersR;
+		// copy up to the end of the current block at most
+		const unsigned int numToCopy = std::min( numSamples, m_NumSamples - pos );
+		T* const readPtr = &currentBuffer[pos];
 
-		for ( IBufferCallback<T, true>* callback : m_Callbacks )
+		readAndWriteBack( readPtr, dst, sampleValsToReadBuf, numToCopy );
+
+		dst += numToCopy;
+		sampleValsToReadBuf = ( sampleValsToReadBuf ) ? sampleValsToReadBuf + numToCopy : nullptr;
+		numSamples -= numToCopy;
+		pos += numToCopy;
+
+		if ( pos == m_NumSamples )
 		{
-			callback->call( nextBufferL, nextBufferR );
-		}
+			pos = 0;
 
-		m_NextReadBlockFilledL = true;
-		m_NextReadBlockFilledR = true;
+			this->advanceReadBlock( currentBuffer, reader, buffers );
+		}
 	}
 }
 
+template <typename T>
+void AudioBuffer<T, true>::triggerCallbacksOnNextPoll (bool writeToBuffer1)
+{
+	// only the read block is considered filled, so the next poll fills every other block
+	const unsigned int readBlock = ( writeToBuffer1 ) ? 0 : 1;
+	m_Ring.startReadingAt( readBlock );
+	m_CurrentBufferL = &m_BuffersL[readBlock * m_NumSamples];
+	m_CurrentBufferR = &m_BuffersR[readBlock * m_NumSamples];
+}
+
+template <typename T>
+void AudioBuffer<T, true>::pollToFillBuffers()
+{
+	this->fillFreeBlocks( [this] (T* writeBufferL, T* writeBufferR, unsigned int numSamples)
+				{
+					for ( IBufferCallback<T, true>* callback : m_Callbacks )
+					{
+						callback->process( writeBufferL, writeBufferR, numSamples );
+					}
+				} );
+}
+
+template <typename T>
+unsigned int AudioBuffer<T, true>::getNextBlockToWrite() const
+{
+	return m_Ring.getNextWriteBlock();
+}
+
+template <typename T>
+const T* AudioBuffer<T, true>::getBlockL (unsigned int block) const
+{
+	return &m_BuffersL[block * m_NumSamples];
+}
+
+template <typename T>
+const T* AudioBuffer<T, true>::getBlockR (unsigned int block) const
+{
+	return &m_BuffersR[block * m_NumSamples];
+}
+
 template <typename T>
 bool AudioBuffer<T, true>::buffer1IsNextToWrite() const
 {
@@ -281,7 +476,7 @@ const T* AudioBuffer<T, true>::getBufferL1() const
 template <typename T>
 const T* AudioBuffer<T, true>::getBufferL2() const
 {
-	return &m_BuffersL[ABUFFER_SIZE];
+	return &m_BuffersL[m_NumSamples];
 }
 
 template <typename T>
@@ -293,11 +488,11 @@ const T* AudioBuffer<T, true>::getBufferR1() const
 template <typename T>
 const T* AudioBuffer<T, true>::getBufferR2() const
 {
-	return &m_BuffersR[ABUFFER_SIZE];
+	return &m_BuffersR[m_NumSamples];
 }
 
 template <typename T>
-const std::set<IBufferCallback<T, true>*>& AudioBuffer<T, true>::getCallbacks() const
+const std::vector<IBufferCallback<T, true>*>& AudioBuffer<T, true>::getCallbacks() const
 {
 	return m_Callbacks;
 }
@@ -305,18 +500,69 @@ const std::set<IBufferCallback<T, true>*>& AudioBuffer<T, true>::getCallbacks()
 template <typename T>
 void AudioBuffer<T, true>::registerCallback (IBufferCallback<T, true>* callback)
 {
-	if ( callback )
+	this->registerCallback( callback, m_Callbacks.size() );
+}
+
+template <typename T>
+void AudioBuffer<T, true>::registerCallback (IBufferCallback<T, true>* callback, unsigned int position)
+{
+	if ( callback && std::find(m_Callbacks.begin(), m_Callbacks.end(), callback) == m_Callbacks.end() )
 	{
-		m_Callbacks.insert(callback);
+		position = std::min( position, static_cast<unsigned int>(m_Callbacks.size()) );
+		m_Callbacks.insert( m_Callbacks.begin() + position, callback );
 	}
 }
 
+template <typename T>
+void AudioBuffer<T, true>::unregisterCallback (IBufferCallback<T, true>* callback)
+{
+	m_Callbacks.erase( std::remove(m_Callbacks.begin(), m_Callbacks.end(), callback), m_Callbacks.end() );
+}
+
+template <typename T>
+void AudioBuffer<T, true>::allocateBuffers (unsigned int numSamples, unsigned int numBlocks)
+{
+	if ( numBlocks < 2 )
+	{
+		numBlocks = 2;
+	}
+
+	if ( numSamples != m_NumSamples || numBlocks != m_NumBlocks )
+	{
+		delete[] m_BuffersL;
+		delete[] m_BuffersR;
+		m_NumSamples = numSamples;
+		m_NumBlocks = numBlocks;
+		m_BuffersL = new T[m_NumSamples * m_NumBlocks]{ 0 };
+		m_BuffersR = new T[m_NumSamples * m_NumBlocks]{ 0 };
+	}
+
+	this->resetCounts();
+}
+
+template <typename T>
+void AudioBuffer<T, true>::advanceReadBlock (T*& currentBuffer, unsigned int reader, T* buffers)
+{
+	currentBuffer = &buffers[ m_Ring.advanceRead(reader) * m_NumSamples ];
+}
+
+template <typename T>
+void AudioBuffer<T, true>::resetCounts()
+{
+	// the reading sides start on the first block with all other blocks considered filled
+	m_Ring.reset( m_NumBlocks );
+	m_CurrentBufferL = m_BuffersL;
+	m_CurrentBufferR = m_BuffersR;
+	m_PosL = 0;
+	m_PosR = 0;
+}
+
 template <typename T>
 T* AudioBuffer<T, true>::getBufferL (bool writeBuffer)
 {
 	if ( writeBuffer )
 	{
-		return &m_BuffersL[ABUFFER_SIZE];
+		return &m_BuffersL[m_NumSamples];
 	}
 	else
 	{
@@ -329,7 +575,7 @@ T* AudioBuffer<T, true>::getBufferR (bool writeBuffer)
 {
 	if ( writeBuffer )
 	{
-		return &m_BuffersR[ABUFFER_SIZE];
+		return &m_BuffersR[m_NumSamples];
 	}
 	else
 	{
@@ -341,20 +587,6 @@ T* AudioBuffer<T, true>::getBufferR (bool writeBuffer)
 template class AudioBuffer<float, false>;
 template class AudioBuffer<uint16_t, false>;
 template class AudioBuffer<int16_t, false>;
-
-// TODO no idea why I have to do this, look into a better way later
-template AudioBuffer<float, true>::AudioBuffer();
-template AudioBuffer<uint16_t, true>::AudioBuffer();
-template AudioBuffer<int16_t, true>::AudioBuffer();
-template void AudioBuffer<float, true>::registerCallback(IBufferCallback<float, true>*);
-template void AudioBuffer<uint16_t, true>::registerCallback(IBufferCallback<uint16_t, true>*);
-template void AudioBuffer<int16_t, true>::registerCallback(IBufferCallback<int16_t, true>*);
-template float AudioBuffer<float, true>::getNextSampleL(float sampleValToRead);
-template uint16_t AudioBuffer<uint16_t, true>::getNextSampleL(uint16_t sampleValToRead);
-template int16_t AudioBuffer<int16_t, true>::getNextSampleL(int16_t sampleValToRead);
-template float AudioBuffer<float, true>::getNextSampleR(float sampleValToRead);
-template uint16_t AudioBuffer<uint16_t, true>::getNextSampleR(uint16_t sampleValToRead);
-template int16_t AudioBuffer<int16_t, true>::getNextSampleR(int16_t sampleValToRead);
-template void AudioBuffer<float, true>::pollToFillBuffers();
-template void AudioBuffer<uint16_t, true>::pollToFillBuffers();
-template void AudioBuffer<int16_t, true>::pollToFillBuffers();
+template class AudioBuffer<float, true>;
+template class AudioBuffer<uint16_t, true>;
+template class AudioBuffer<int16_t, true>;
@@ -0,0 +1,298 @@
+#include "FIRKernels.hpp"
+
+#include <atomic>
+
+// the SIMD kernels need to match the scalar kernel bit for bit, so multiplies and adds must never be fused
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define FIR_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && ! defined(__clang__)
+#include <intrin.h>
+#define FIR_TARGET(isa)
+#else
+#define FIR_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FIR_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+constexpr unsigned int NUM_LANES = 16;
+
+using DotProductFunc = float (*)(const float* const, const float* const, const unsigned int);
+
+// the leftover taps and the reduction of the lanes are shared by all kernels so they're always done in the same order
+static inline float finishDotProduct (float* const lanes, const float* const history, const float* const coefficients,
+					const unsigned int firstTap, const unsigned int numTaps)
+{
+	for ( unsigned int tap = firstTap; tap < numTaps; tap++ )
+	{
+		lanes[tap - firstTap] = lanes[tap - firstTap] + ( history[tap] * coefficients[tap] );
+	}
+
+	for ( unsigned int width = NUM_LANES / 2; width > 0; width /= 2 )
+	{
+		for ( unsigned int lane = 0; lane < width; lane++ )
+		{
+			lanes[lane] = lanes[lane] + lanes[lane + width];
+		}
+	}
+
+	return lanes[0];
+}
+
+static float dotProductScalar (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	float lanes[NUM_LANES] = { 0.0f };
+	const unsigned int numBlockTaps = numTaps - ( numTaps % NUM_LANES );
+
+	for ( unsigned int tap = 0; tap < numBlockTaps; tap += NUM_LANES )
+	{
+		for ( unsigned int lane = 0; lane < NUM_LANES; lane++ )
+		{
+			lanes[lane] = lanes[lane] + ( history[tap + lane] * coefficients[tap + lane] );
+		}
+	}
+
+	return finishDotProduct( lanes, history, coefficients, numBlockTaps, numTaps );
+}
+
+#if defined(FIR_KERNELS_X86)
+FIR_TARGET("sse2")
+static float dotProductSSE2 (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	__m128 acc2 = _mm_setzero_ps();
+	__m128 acc3 = _mm_setzero_ps();
+	const unsigned int numBlockTaps = numTaps - ( numTaps % NUM_LANES );
+
+	for ( unsigned int tap = 0; tap < numBlockTaps; tap += NUM_LANES )
+	{
+		acc0 = _mm_add_ps( acc0, _mm_mul_ps(_mm_loadu_ps(&history[tap + 0]), _mm_loadu_ps(&coefficients[tap + 0])) );
+		acc1 = _mm_add_ps( acc1, _mm_mul_ps(_mm_loadu_ps(&history[tap + 4]), _mm_loadu_ps(&coefficients[tap + 4])) );
+		acc2 = _mm_add_ps( acc2, _mm_mul_ps(_mm_loadu_ps(&history[tap + 8]), _mm_loadu_ps(&coefficients[tap + 8])) );
+		acc3 = _mm_add_ps( acc3, _mm_mul_ps(_mm_loadu_ps(&history[tap + 12]), _mm_loadu_ps(&coefficients[tap + 12])) );
+	}
+
+	float lanes[NUM_LANES];
+	_mm_storeu_ps( &lanes[0], acc0 );
+	_mm_storeu_ps( &lanes[4], acc1 );
+	_mm_storeu_ps( &lanes[8], acc2 );
+	_mm_storeu_ps( &lanes[12], acc3 );
+
+	return finishDotProduct( lanes, history, coefficients, numBlockTaps, numTaps );
+}
+
+FIR_TARGET("avx2")
+static float dotProductAVX2 (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	__m256 acc0 = _mm256_setzero_ps();
+	__m256 acc1 = _mm256_setzero_ps();
+	const unsigned int numBlockTaps = numTaps - ( numTaps % NUM_LANES );
+
+	for ( unsigned int tap = 0; tap < numBlockTaps; tap += NUM_LANES )
+	{
+		acc0 = _mm256_add_ps( acc0, _mm256_mul_ps(_mm256_loadu_ps(&history[tap + 0]), _mm256_loadu_ps(&coefficients[tap + 0])) );
+		acc1 = _mm256_add_ps( acc1, _mm256_mul_ps(_mm256_loadu_ps(&history[tap + 8]), _mm256_loadu_ps(&coefficients[tap + 8])) );
+	}
+
+	float lanes[NUM_LANES];
+	_mm256_storeu_ps( &lanes[0], acc0 );
+	_mm256_storeu_ps( &lanes[8], acc1 );
+
+	return finishDotProduct( lanes, history, coefficients, numBlockTaps, numTaps );
+}
+
+FIR_TARGET("avx512f")
+static float dotProductAVX512 (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	__m512 acc = _mm512_setzero_ps();
+	const unsigned int numBlockTaps = numTaps - ( numTaps % NUM_LANES );
+
+	for ( unsigned int tap = 0; tap < numBlockTaps; tap += NUM_LANES )
+	{
+		acc = _mm512_add_ps( acc, _mm512_mul_ps(_mm512_loadu_ps(&history[tap]), _mm512_loadu_ps(&coefficients[tap])) );
+	}
+
+	float lanes[NUM_LANES];
+	_mm512_storeu_ps( &lanes[0], acc );
+
+	return finishDotProduct( lanes, history, coefficients, numBlockTaps, numTaps );
+}
+
+#if defined(_MSC_VER) && ! defined(__clang__)
+static bool cpuSupports (const FIRKernel kernel)
+{
+	int info[4] = { 0 };
+	__cpuid( info, 1 );
+	const bool sse2 = ( info[3] & (1 << 26) ) != 0;
+	const bool osxsave = ( info[2] & (1 << 27) ) != 0;
+	const unsigned long long xcr0 = ( osxsave ) ? _xgetbv( 0 ) : 0;
+
+	__cpuidex( info, 7, 0 );
+	const bool avx2 = ( info[1] & (1 << 5) ) != 0 && ( xcr0 & 0x6 ) == 0x6;
+	const bool avx512f = ( info[1] & (1 << 16) ) != 0 && ( xcr0 & 0xE6 ) == 0xE6;
+
+	switch ( kernel )
+	{
+		case FIRKernel::SSE2:
+			return sse2;
+		case FIRKernel::AVX2:
+			return avx2;
+		case FIRKernel::AVX512:
+			return avx512f;
+		default:
+			return false;
+	}
+}
+#else
+static bool cpuSupports (const FIRKernel kernel)
+{
+	__builtin_cpu_init();
+
+	switch ( kernel )
+	{
+		case FIRKernel::SSE2:
+			return __builtin_cpu_supports( "sse2" );
+		case FIRKernel::AVX2:
+			return __builtin_cpu_supports( "avx2" );
+		case FIRKernel::AVX512:
+			return __builtin_cpu_supports( "avx512f" );
+		default:
+			return false;
+	}
+}
+#endif // _MSC_VER
+#endif // FIR_KERNELS_X86
+
+#if defined(FIR_KERNELS_NEON)
+static float dotProductNEON (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	float32x4_t acc0 = vdupq_n_f32( 0.0f );
+	float32x4_t acc1 = vdupq_n_f32( 0.0f );
+	float32x4_t acc2 = vdupq_n_f32( 0.0f );
+	float32x4_t acc3 = vdupq_n_f32( 0.0f );
+	const unsigned int numBlockTaps = numTaps - ( numTaps % NUM_LANES );
+
+	for ( unsigned int tap = 0; tap < numBlockTaps; tap += NUM_LANES )
+	{
+		acc0 = vaddq_f32( acc0, vmulq_f32(vld1q_f32(&history[tap + 0]), vld1q_f32(&coefficients[tap + 0])) );
+		acc1 = vaddq_f32( acc1, vmulq_f32(vld1q_f32(&history[tap + 4]), vld1q_f32(&coefficients[tap + 4])) );
+		acc2 = vaddq_f32( acc2, vmulq_f32(vld1q_f32(&history[tap + 8]), vld1q_f32(&coefficients[tap + 8])) );
+		acc3 = vaddq_f32( acc3, vmulq_f32(vld1q_f32(&history[tap + 12]), vld1q_f32(&coefficients[tap + 12])) );
+	}
+
+	float lanes[NUM_LANES];
+	vst1q_f32( &lanes[0], acc0 );
+	vst1q_f32( &lanes[4], acc1 );
+	vst1q_f32( &lanes[8], acc2 );
+	vst1q_f32( &lanes[12], acc3 );
+
+	return finishDotProduct( lanes, history, coefficients, numBlockTaps, numTaps );
+}
+#endif // FIR_KERNELS_NEON
+
+static DotProductFunc getDotProductFunc (const FIRKernel kernel)
+{
+	switch ( kernel )
+	{
+#if defined(FIR_KERNELS_X86)
+		case FIRKernel::SSE2:
+			return dotProductSSE2;
+		case FIRKernel::AVX2:
+			return dotProductAVX2;
+		case FIRKernel::AVX512:
+			return dotProductAVX512;
+#endif // FIR_KERNELS_X86
+#if defined(FIR_KERNELS_NEON)
+		case FIRKernel::NEON:
+			return dotProductNEON;
+#endif // FIR_KERNELS_NEON
+		default:
+			return dotProductScalar;
+	}
+}
+
+static float dotProductResolve (const float* const history, const float* const coefficients, const unsigned int numTaps);
+
+// starts out pointing at dotProductResolve, which picks the best kernel the first time it's called
+static std::atomic<DotProductFunc> s_DotProduct( dotProductResolve );
+static std::atomic<FIRKernel> s_Kernel( FIRKernel::SCALAR );
+
+static void resolveFIRKernel()
+{
+	const FIRKernel kernelsByPreference[] = { FIRKernel::AVX512, FIRKernel::AVX2, FIRKernel::SSE2, FIRKernel::NEON };
+
+	for ( const FIRKernel kernel : kernelsByPreference )
+	{
+		if ( setFIRKernel(kernel) )
+		{
+			return;
+		}
+	}
+
+	setFIRKernel( FIRKernel::SCALAR );
+}
+
+static float dotProductResolve (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	resolveFIRKernel();
+
+	return s_DotProduct.load( std::memory_order_relaxed )( history, coefficients, numTaps );
+}
+
+float firDotProduct (const float* const history, const float* const coefficients, const unsigned int numTaps)
+{
+	return s_DotProduct.load( std::memory_order_relaxed )( history, coefficients, numTaps );
+}
+
+FIRKernel getFIRKernel()
+{
+	if ( s_DotProduct.load(std::memory_order_relaxed) == dotProductResolve )
+	{
+		resolveFIRKernel();
+	}
+
+	return s_Kernel.load( std::memory_order_relaxed );
+}
+
+bool firKernelIsSupported (const FIRKernel kernel)
+{
+	switch ( kernel )
+	{
+		case FIRKernel::SCALAR:
+			return true;
+#if defined(FIR_KERNELS_X86)
+		case FIRKernel::SSE2:
+		case FIRKernel::AVX2:
+		case FIRKernel::AVX512:
+			return cpuSupports( kernel );
+#endif // FIR_KERNELS_X86
+#if defined(FIR_KERNELS_NEON)
+		case FIRKernel::NEON:
+			return true;
+#endif // FIR_KERNELS_NEON
+		default:
+			return false;
+	}
+}
+
+bool setFIRKernel (const FIRKernel kernel)
+{
+	if ( ! firKernelIsSupported(kernel) )
+	{
+		return false;
+	}
+
+	s_Kernel.store( kernel, std::memory_order_relaxed );
+	s_DotProduct.store( getDotProductFunc(kernel), std::memory_order_relaxed );
+
+	return true;
+}
@@ -34,9 +34,9 @@ Limiter<T>::~Limiter()
 }
 
 template <typename T>
-void Limiter<T>::call (T* writeBuffer)
+void Limiter<T>::process (T* writeBuffer, unsigned int numSamples)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		// envelope follower
 		const float absoluteSampleVal = std::fabs( writeBuffer[sample] );
@@ -7,8 +7,3 @@ LinearResponse::LinearResponse()
 LinearResponse::~LinearResponse()
 {
 }
-
-float LinearResponse::response (const float value, const float minValue, const float maxValue) const
-{
-	return value;
-}
@@ -24,9 +24,9 @@ NoiseGate<T>::~NoiseGate()
 }
 
 template <typename T>
-void NoiseGate<T>::call (T* writeBuffer)
+void NoiseGate<T>::process (T* writeBuffer, unsigned int numSamples)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		// envelope follower
 		T absoluteSampleVal = std::abs( writeBuffer[sample] );
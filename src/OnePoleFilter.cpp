@@ -41,9 +41,9 @@ void OnePoleFilter<T>::setCoefficients (float frequency)
 }
 
 template <typename T>
-void OnePoleFilter<T>::call (T* writeBuffer)
+void OnePoleFilter<T>::process (T* writeBuffer, unsigned int numSamples)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		writeBuffer[sample] = this->processSampleHelper( writeBuffer[sample] );
 	}
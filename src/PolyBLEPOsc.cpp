@@ -3,21 +3,149 @@
 #define _USE_MATH_DEFINES
 
 #include "AudioConstants.hpp"
+#include <algorithm>
 #include <limits>
 #include <cmath>
-#if defined(TARGET_BUILD) && ( defined(ARM_MATH_CM7) || defined(ARM_MATH_CM4) )
-#include <arm_math.h>
-#endif // TARGET_BUILD and ARM_MATH
+#include <vector>
+
+// modulated blocks work out the phase increments for this many samples at a time before rendering them
+constexpr unsigned int MODULATION_CHUNK_SIZE = 64;
+
+// a whole cycle of the integer phase, and the scale from its top 24 bits (which a float holds exactly) to 0 to 1
+constexpr double PHASE_CYCLE = 4294967296.0;
+constexpr float PHASE_TOP_BITS_TO_FLOAT = 1.0f / 16777216.0f;
+constexpr double MAX_PHASE_INCR = ( PHASE_CYCLE / 2.0 ) - 1.0; // a step under the nyquist frequency
+
+static inline float phaseToFloat (const uint32_t phase)
+{
+	return static_cast<float>( phase >> 8 ) * PHASE_TOP_BITS_TO_FLOAT;
+}
+
+// 1 if the condition is true and 0 if it isn't, going through an int keeps the compiler from turning it back into a branch
+static inline float gainIf (const bool condition)
+{
+	return static_cast<float>( static_cast<int>(condition) );
+}
+
+// t is the phase from 0 to 1 and width is how far the phase moves each sample
+static inline float polyBLEP (const float t, const float width, const float invWidth)
+{
+	if ( t < width )
+	{
+		const float x = t * invWidth;
+		return x+x - x*x - 1.0f;
+	}
+	else if ( t > 1.0f - width )
+	{
+		const float x = ( t - 1.0f ) * invWidth;
+		return x*x + x+x + 1.0f;
+	}
+
+	return 0.0f;
+}
+
+// the step response of a blackman windowed sinc, from SINC_BLEP_ZERO_CROSSINGS samples before the step to as many after it
+static std::vector<float> buildSincBLEPStep()
+{
+	const unsigned int numPoints = ( 2 * SINC_BLEP_ZERO_CROSSINGS * SINC_BLEP_OVERSAMPLING ) + 1;
+	std::vector<double> kernel( numPoints );
+	for ( unsigned int point = 0; point < numPoints; point++ )
+	{
+		const double x = ( static_cast<double>(point) / SINC_BLEP_OVERSAMPLING ) - SINC_BLEP_ZERO_CROSSINGS;
+		const double sinc = ( x == 0.0 ) ? 1.0 : sin( M_PI * x ) / ( M_PI * x );
+		const double windowPos = static_cast<double>( point ) / static_cast<double>( numPoints - 1 );
+		const double window = 0.42 - ( 0.5 * cos(2.0 * M_PI * windowPos) ) + ( 0.08 * cos(4.0 * M_PI * windowPos) );
+
+		kernel[point] = sinc * window;
+	}
+
+	// integrating with the trapezoid rule, then scaling so the step ends at exactly 1
+	std::vector<double> step( numPoints, 0.0 );
+	for ( unsigned int point = 1; point < numPoints; point++ )
+	{
+		step[point] = step[point - 1] + ( 0.5 * (kernel[point - 1] + kernel[point]) );
+	}
+
+	std::vector<float> stepTable( numPoints + 1 );
+	for ( unsigned int point = 0; point < numPoints; point++ )
+	{
+		stepTable[point] = static_cast<float>( step[point] / step[numPoints - 1] );
+	}
+	stepTable[numPoints] = stepTable[numPoints - 1]; // guard point for the interpolation
+
+	return stepTable;
+}
+
+static const std::vector<float> s_SincBLEPStep = buildSincBLEPStep();
+
+// distance is how many samples after the step (or before, if negative) the sample is
+static inline float sincBLEPStep (const float distance)
+{
+	const float position = ( distance + static_cast<float>(SINC_BLEP_ZERO_CROSSINGS) ) * static_cast<float>( SINC_BLEP_OVERSAMPLING );
+	const unsigned int index = static_cast<unsigned int>( position );
+	const float fraction = position - static_cast<float>( index );
+	const float* const points = &s_SincBLEPStep[index];
+
+	return points[0] + ( (points[1] - points[0]) * fraction );
+}
+
+// the same residual as polyBLEP, from the windowed sinc step instead of a 2 sample polynomial
+static inline float sincBLEP (const float t, const float width, const float invWidth)
+{
+	constexpr float zeroCrossings = static_cast<float>( SINC_BLEP_ZERO_CROSSINGS );
+	float residual = 0.0f;
+
+	// at high frequencies the samples before and after the wrap can overlap, so both are checked
+	if ( t < zeroCrossings * width )
+	{
+		residual += 2.0f * ( sincBLEPStep(t * invWidth) - 1.0f );
+	}
+	if ( t > 1.0f - (zeroCrossings * width) )
+	{
+		residual += 2.0f * sincBLEPStep( (t - 1.0f) * invWidth );
+	}
+
+	return residual;
+}
+
+template <BLEPQuality quality>
+static inline float blep (const float t, const float width, const float invWidth)
+{
+	if constexpr ( quality == BLEPQuality::WINDOWED_SINC )
+	{
+		return sincBLEP( t, width, invWidth );
+	}
+	else
+	{
+		return polyBLEP( t, width, invWidth );
+	}
+}
+
+// wraps any phase into 0 to 1
+static inline float wrapPhase (const float phase)
+{
+	const float wrapped = phase - std::floor( phase );
+
+	return ( wrapped < 1.0f ) ? wrapped : 0.0f; // tiny negative phases can round up to 1
+}
 
 PolyBLEPOsc::PolyBLEPOsc() :
 	m_Frequency( 0.0f ),
-	m_Phase( 0.0f ),
-	m_PhaseIncr( 0.0f ),
+	m_Phase( 0 ),
+	m_PhaseIncr( 0 ),
+	m_BLEPWidth( 0.0f ),
+	m_InvBLEPWidth( 0.0f ),
 	m_LastOutput( 0.0f ),
 	m_LastLastOutput( 0.0f ),
 	m_A0( 1.0f ),
 	m_B1( 0.0f ),
-	m_OscMode( OscillatorMode::SINE )
+	m_SyncOut( -1.0f ),
+	m_OscMode( OscillatorMode::SINE ),
+	m_BLEPQuality( BLEPQuality::POLYNOMIAL ),
+	m_SineTable( Wavetable::getSineTable().get() ),
+	m_Wavetable( nullptr ),
+	m_BlockSineTable( m_SineTable.load() ),
+	m_BlockWavetable( nullptr )
 {
 }
 
@@ -25,101 +153,259 @@ PolyBLEPOsc::~PolyBLEPOsc()
 {
 }
 
-float PolyBLEPOsc::nextSample()
+template <OscillatorMode mode, BLEPQuality quality>
+inline float PolyBLEPOsc::renderWaveform (const float t, const float width, const float invWidth, const float pulseWidth) const
+{
+	if constexpr ( mode == OscillatorMode::SINE )
+	{
+		return m_BlockSineTable->lookup( t );
+	}
+	else if constexpr ( mode == OscillatorMode::WAVETABLE )
+	{
+		return ( m_BlockWavetable ) ? m_BlockWavetable->lookup( t ) : 0.0f;
+	}
+	else if constexpr ( mode == OscillatorMode::SAWTOOTH )
+	{
+		// generate sawtooth waveform and apply PolyBLEP
+		return ( 2.0f * t ) - 1.0f + this->wrapBLEP<mode, quality>( t, width, invWidth );
+	}
+	else
+	{
+		// generate pulse waveform, the second PolyBLEP is for the discontinuity at the pulse width
+		const float pulseT = ( t < pulseWidth ) ? t - pulseWidth + 1.0f : t - pulseWidth;
+		float output = ( t < pulseWidth ) ? 1.0f : -1.0f;
+		output += this->wrapBLEP<mode, quality>( t, width, invWidth );
+		output -= blep<quality>( pulseT, width, invWidth );
+
+		return output;
+	}
+}
+
+template <OscillatorMode mode, BLEPQuality quality>
+inline float PolyBLEPOsc::wrapBLEP (const float t, const float width, const float invWidth) const
+{
+	// only the sawtooth and pulse waves jump where the phase wraps, down for the sawtooth and up for the pulse
+	if constexpr ( mode == OscillatorMode::SAWTOOTH )
+	{
+		return -blep<quality>( t, width, invWidth );
+	}
+	else if constexpr ( mode == OscillatorMode::SQUARE || mode == OscillatorMode::TRIANGLE )
+	{
+		return blep<quality>( t, width, invWidth );
+	}
+	else
+	{
+		return 0.0f;
+	}
+}
+
+template <OscillatorMode mode>
+inline float PolyBLEPOsc::naiveWaveform (const float t, const float pulseWidth) const
+{
+	if constexpr ( mode == OscillatorMode::SINE || mode == OscillatorMode::WAVETABLE )
+	{
+		return this->renderWaveform<mode, BLEPQuality::POLYNOMIAL>( t, 0.0f, 0.0f, pulseWidth );
+	}
+	else if constexpr ( mode == OscillatorMode::SAWTOOTH )
+	{
+		return ( 2.0f * t ) - 1.0f;
+	}
+	else
+	{
+		return ( t < pulseWidth ) ? 1.0f : -1.0f;
+	}
+}
+
+inline float PolyBLEPOsc::filterTriangle (const float pulse)
 {
-	float output = 0.0f;
+	// doing some filtering to make a triangle wave
+	m_LastLastOutput = (pulse * m_A0) + (m_LastOutput * m_B1);
+	m_LastOutput = (m_LastOutput * m_A0) + (m_LastLastOutput * m_B1);
 
-	if ( m_OscMode != OscillatorMode::SINE ) // if not a sine wave, we need to anti-alias using PolyBLEP
+	return m_LastOutput;
+}
+
+template <OscillatorMode mode, BLEPQuality quality>
+inline float PolyBLEPOsc::renderSample()
+{
+	float output = this->renderWaveform<mode, quality>( phaseToFloat(m_Phase), m_BLEPWidth, m_InvBLEPWidth, 0.5f );
+
+	if constexpr ( mode == OscillatorMode::TRIANGLE )
+	{
+		output = this->filterTriangle( output );
+	}
+
+	// the phase wraps on its own, in either direction
+	m_Phase += m_PhaseIncr;
+
+	return output;
+}
+
+template <OscillatorMode mode, BLEPQuality quality>
+void PolyBLEPOsc::renderBlock (float* writeBuffer, unsigned int numSamples)
+{
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
-		// calculate PolyBLEP to be used for SAW, SQUARE, and TRIANGLE
-		float t = std::abs(m_Phase) / (2.0f * M_PI); // using abs since a frequency of 0 can cause NAN
-		float dt = std::abs(m_PhaseIncr) / (2.0f * M_PI);
-		float polyBLEPOutput = 0.0f;
-		float polyBLEPSquareOutput = 0.0f;
-		if ( t < dt )
+		writeBuffer[sample] = this->renderSample<mode, quality>();
+	}
+}
+
+template <OscillatorMode mode, BLEPQuality quality>
+void PolyBLEPOsc::renderModulatedBlock (float* writeBuffer, unsigned int numSamples, const PolyBLEPModulation& modulation)
+{
+	int32_t phaseIncrs[MODULATION_CHUNK_SIZE];
+	float blepWidths[MODULATION_CHUNK_SIZE];
+	float invBLEPWidths[MODULATION_CHUNK_SIZE];
+	uint32_t phase = m_Phase;
+
+	for ( unsigned int chunkStart = 0; chunkStart < numSamples; chunkStart += MODULATION_CHUNK_SIZE )
+	{
+		const unsigned int chunkSize = std::min( numSamples - chunkStart, MODULATION_CHUNK_SIZE );
+
+		if ( modulation.frequency )
 		{
-			t /= dt;
-			polyBLEPOutput = t+t - t*t - 1.0f;
+			// this loop has no dependencies between samples, so it vectorizes
+			const float* const frequencies = &modulation.frequency[chunkStart];
+			for ( unsigned int sample = 0; sample < chunkSize; sample++ )
+			{
+				// at or past the nyquist frequency the increment is clamped to a step under it so it fits, otherwise it's
+				// rounded half away from 0 like setFrequency (the conversion truncates). The clamps are gains of 0 or 1,
+				// since comparisons would become branches
+				const float overGain = gainIf( frequencies[sample] >= NYQUIST_FREQ );
+				const float underGain = gainIf( frequencies[sample] <= -NYQUIST_FREQ );
+				const float clampGain = overGain + underGain;
+				const double unclampedIncr = static_cast<double>( frequencies[sample] ) * ( PHASE_CYCLE / SAMPLE_RATE );
+				const double phaseIncr = ( unclampedIncr * static_cast<double>(1.0f - clampGain) )
+								+ ( MAX_PHASE_INCR * static_cast<double>(overGain - underGain) );
+				phaseIncrs[sample] = static_cast<int32_t>( phaseIncr + std::copysign(0.5, phaseIncr) );
+				blepWidths[sample] = ( std::abs(frequencies[sample] / SAMPLE_RATE) * (1.0f - clampGain) ) + ( 0.5f * clampGain );
+
+				// the inverse is never used when the width is 0, it just can't be infinite, and adding the smallest
+				// float is cheaper than a comparison and too small to change any other width
+				invBLEPWidths[sample] = 1.0f / ( blepWidths[sample] + std::numeric_limits<float>::min() );
+			}
 		}
-		else if ( t > 1.0f - dt )
+		else
 		{
-			t = (t - 1.0f) / dt;
-			polyBLEPOutput = t*t + t+t + 1.0f;
+			std::fill( phaseIncrs, phaseIncrs + chunkSize, static_cast<int32_t>(m_PhaseIncr) );
+			std::fill( blepWidths, blepWidths + chunkSize, m_BLEPWidth );
+			std::fill( invBLEPWidths, invBLEPWidths + chunkSize, m_InvBLEPWidth );
 		}
 
-		if ( m_OscMode == OscillatorMode::SQUARE || m_OscMode == OscillatorMode::TRIANGLE )
+		for ( unsigned int chunkSample = 0; chunkSample < chunkSize; chunkSample++ )
 		{
-			// calculate PolyBLEP for square wave (which later can be integrated into a triangle wave)
-			t = fmodf( (std::abs(m_Phase) / (2.0f * M_PI)) + 0.5f, 1.0f );
+			const unsigned int sample = chunkStart + chunkSample;
+			const int32_t phaseIncr = phaseIncrs[chunkSample];
+			const float phaseOffset = ( modulation.phase ) ? modulation.phase[sample] : 0.0f;
+			const float pulseWidth = ( modulation.pulseWidth ) ? std::min( std::max(modulation.pulseWidth[sample], 0.0f), 1.0f ) : 0.5f;
 
-			if ( t < dt )
+			if ( modulation.syncOut )
 			{
-				t /= dt;
-				polyBLEPSquareOutput = t+t - t*t - 1.0f;
+				modulation.syncOut[sample] = m_SyncOut;
 			}
-			else if ( t > 1.0f - dt )
+
+			const float unsyncedT = ( modulation.phase ) ? wrapPhase( phaseToFloat(phase) + phaseOffset ) : phaseToFloat( phase );
+			float t = unsyncedT;
+
+			// restart the cycle, with a PolyBLEP the size of the jump on either side of the reset
+			float syncBeforeBLEP = 0.0f;
+			float syncAfterBLEP = 0.0f;
+			if ( modulation.sync && modulation.sync[sample] >= 0.0f )
 			{
-				t = (t - 1.0f) / dt;
-				polyBLEPSquareOutput = t*t + t+t + 1.0f;
+				const float sinceReset = std::min( modulation.sync[sample], 1.0f );
+				phase = static_cast<uint32_t>( static_cast<int32_t>(sinceReset * static_cast<float>(phaseIncr)) );
+				t = ( modulation.phase ) ? wrapPhase( phaseToFloat(phase) + phaseOffset ) : phaseToFloat( phase );
+
+				// the jump is measured now instead of at the reset, which is the same for waves that are straight lines
+				const float halfJump = 0.5f * ( this->naiveWaveform<mode>(t, pulseWidth) - this->naiveWaveform<mode>(unsyncedT, pulseWidth) );
+				syncBeforeBLEP = halfJump * sinceReset * sinceReset;
+				syncAfterBLEP = -halfJump * ( 1.0f - sinceReset ) * ( 1.0f - sinceReset );
+
+				// the reset is why the phase is next to the wrap, so the PolyBLEP for wrapping doesn't belong here
+				syncAfterBLEP -= this->wrapBLEP<mode, quality>( t, blepWidths[chunkSample], invBLEPWidths[chunkSample] );
 			}
 
-			// generate square waveform
-			if ( m_Phase < M_PI )
+			float output = this->renderWaveform<mode, quality>( t, blepWidths[chunkSample], invBLEPWidths[chunkSample], pulseWidth );
+
+			if constexpr ( mode == OscillatorMode::TRIANGLE )
 			{
-				output = 1.0f;
+				// the filter smooths the pulse enough that both halves can go in now
+				output = this->filterTriangle( output + syncBeforeBLEP + syncAfterBLEP );
+			}
+			else if ( sample > 0 )
+			{
+				writeBuffer[sample - 1] += syncBeforeBLEP;
+				output += syncAfterBLEP;
 			}
 			else
 			{
-				output = -1.0f;
+				output += syncBeforeBLEP + syncAfterBLEP;
 			}
 
-			// apply PolyBLEPs to square
-			output += polyBLEPOutput;
-			output -= polyBLEPSquareOutput;;
+			writeBuffer[sample] = output;
 
-			if ( m_OscMode == OscillatorMode::TRIANGLE )
+			// increment and wrap phase, a sync output is how long ago the phase wrapped as of the next sample
+			const uint32_t lastPhase = phase;
+			phase += static_cast<uint32_t>( phaseIncr );
+			m_SyncOut = -1.0f;
+			if ( phaseIncr > 0 && phase < lastPhase )
 			{
-				// doing some filtering to make a triangle wave
-				m_LastLastOutput = (output * m_A0) + (m_LastOutput * m_B1);
-				m_LastOutput = (m_LastOutput * m_A0) + (m_LastLastOutput * m_B1);
-
-				output = m_LastOutput;
+				m_SyncOut = static_cast<float>( phase ) * static_cast<float>( 1.0 / PHASE_CYCLE ) * invBLEPWidths[chunkSample];
+			}
+			else if ( phaseIncr < 0 && phase > lastPhase )
+			{
+				m_SyncOut = static_cast<float>( 0u - phase ) * static_cast<float>( 1.0 / PHASE_CYCLE ) * invBLEPWidths[chunkSample];
 			}
 		}
-		else if ( m_OscMode == OscillatorMode::SAWTOOTH )
-		{
-			// generate sawtooth waveform and apply PolyBLEP
-			output = ( (2.0f * m_Phase) / (2.0f * M_PI) ) - 1.0f;
-			output -= polyBLEPOutput;
-		}
-	}
-	else
-	{
-#if defined(TARGET_BUILD) && ( defined(ARM_MATH_CM7) || defined(ARM_MATH_CM4) )
-		output = arm_sin_f32( m_Phase ); // arm fast math (table based)
-#else
-		output = std::sin( m_Phase );
-#endif // TARGET_BUILD and ARM_MATH
 	}
 
-	// increment and wrap phase
-	m_Phase += m_PhaseIncr;
-	if ( m_Phase > (2.0f * M_PI) )
+	m_Phase = phase;
+}
+
+template <BLEPQuality quality>
+float PolyBLEPOsc::nextSampleWithQuality()
+{
+	switch ( m_OscMode )
 	{
-		m_Phase -= (2.0f * M_PI);
+		case OscillatorMode::TRIANGLE:
+			return this->renderSample<OscillatorMode::TRIANGLE, quality>();
+		case OscillatorMode::SQUARE:
+			return this->renderSample<OscillatorMode::SQUARE, quality>();
+		case OscillatorMode::SAWTOOTH:
+			return this->renderSample<OscillatorMode::SAWTOOTH, quality>();
+		case OscillatorMode::WAVETABLE:
+			return this->renderSample<OscillatorMode::WAVETABLE, quality>();
+		case OscillatorMode::SINE:
+		default:
+			return this->renderSample<OscillatorMode::SINE, quality>();
 	}
-	else if ( m_Phase < (-2.0f * M_PI) ) // we also wrap for negative frequency
+}
+
+float PolyBLEPOsc::nextSample()
+{
+	this->loadTables();
+
+	switch ( m_BLEPQuality )
 	{
-		m_Phase += (2.0f * M_PI);
+		case BLEPQuality::WINDOWED_SINC:
+			return this->nextSampleWithQuality<BLEPQuality::WINDOWED_SINC>();
+		case BLEPQuality::POLYNOMIAL:
+		default:
+			return this->nextSampleWithQuality<BLEPQuality::POLYNOMIAL>();
 	}
-
-	return output;
 }
 
 void PolyBLEPOsc::setFrequency (float frequency)
 {
 	m_Frequency = frequency;
-	m_PhaseIncr = (m_Frequency * 2.0f * M_PI) / SAMPLE_RATE;
+
+	// negative frequencies wrap around to an increment that counts the phase down
+	const long long phaseIncr = std::llround( static_cast<double>(m_Frequency) * PHASE_CYCLE / SAMPLE_RATE );
+	m_PhaseIncr = static_cast<uint32_t>( phaseIncr );
+
+	// the width is always positive since the frequency can be negative, and a frequency of 0 has no discontinuities to smooth
+	m_BLEPWidth = std::abs( m_Frequency / SAMPLE_RATE );
+	m_InvBLEPWidth = ( m_BLEPWidth > 0.0f ) ? 1.0f / m_BLEPWidth : 0.0f;
 }
 
 void PolyBLEPOsc::setOscillatorMode (const OscillatorMode& mode)
@@ -132,11 +418,87 @@ OscillatorMode PolyBLEPOsc::getOscillatorMode()
 	return m_OscMode;
 }
 
-void PolyBLEPOsc::call (float* writeBuffer)
+template <BLEPQuality quality>
+void PolyBLEPOsc::processWithQuality (float* writeBuffer, unsigned int numSamples)
+{
+	switch ( m_OscMode )
+	{
+		case OscillatorMode::TRIANGLE:
+			this->renderBlock<OscillatorMode::TRIANGLE, quality>( writeBuffer, numSamples );
+			break;
+		case OscillatorMode::SQUARE:
+			this->renderBlock<OscillatorMode::SQUARE, quality>( writeBuffer, numSamples );
+			break;
+		case OscillatorMode::SAWTOOTH:
+			this->renderBlock<OscillatorMode::SAWTOOTH, quality>( writeBuffer, numSamples );
+			break;
+		case OscillatorMode::WAVETABLE:
+			this->renderBlock<OscillatorMode::WAVETABLE, quality>( writeBuffer, numSamples );
+			break;
+		case OscillatorMode::SINE:
+		default:
+			this->renderBlock<OscillatorMode::SINE, quality>( writeBuffer, numSamples );
+	}
+}
+
+void PolyBLEPOsc::process (float* writeBuffer, unsigned int numSamples)
+{
+	// the mode and quality can only change between blocks, so they're only checked once per block
+	this->loadTables();
+
+	switch ( m_BLEPQuality )
+	{
+		case BLEPQuality::WINDOWED_SINC:
+			this->processWithQuality<BLEPQuality::WINDOWED_SINC>( writeBuffer, numSamples );
+			break;
+		case BLEPQuality::POLYNOMIAL:
+		default:
+			this->processWithQuality<BLEPQuality::POLYNOMIAL>( writeBuffer, numSamples );
+	}
+
+	// unmodulated blocks don't track sync outputs
+	m_SyncOut = -1.0f;
+}
+
+template <BLEPQuality quality>
+void PolyBLEPOsc::processModulatedWithQuality (float* writeBuffer, unsigned int numSamples, const PolyBLEPModulation& modulation)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	switch ( m_OscMode )
 	{
-		writeBuffer[sample] = this->nextSample();
+		case OscillatorMode::TRIANGLE:
+			this->renderModulatedBlock<OscillatorMode::TRIANGLE, quality>( writeBuffer, numSamples, modulation );
+			break;
+		case OscillatorMode::SQUARE:
+			this->renderModulatedBlock<OscillatorMode::SQUARE, quality>( writeBuffer, numSamples, modulation );
+			break;
+		case OscillatorMode::SAWTOOTH:
+			this->renderModulatedBlock<OscillatorMode::SAWTOOTH, quality>( writeBuffer, numSamples, modulation );
+			break;
+		case OscillatorMode::WAVETABLE:
+			this->renderModulatedBlock<OscillatorMode::WAVETABLE, quality>( writeBuffer, numSamples, modulation );
+			break;
+		case OscillatorMode::SINE:
+		default:
+			this->renderModulatedBlock<OscillatorMode::SINE, quality>( writeBuffer, numSamples, modulation );
+	}
+}
+
+void PolyBLEPOsc::processModulated (float* writeBuffer, unsigned int numSamples, const PolyBLEPModulation& modulation)
+{
+	// a sync reset cancels the wrap the phase was heading for, and the samples a windowed sinc BLEP spreads around a
+	// wrap can't all be taken back, so synced blocks use the polynomial BLEP throughout
+	const BLEPQuality quality = ( modulation.sync ) ? BLEPQuality::POLYNOMIAL : m_BLEPQuality;
+
+	this->loadTables();
+
+	switch ( quality )
+	{
+		case BLEPQuality::WINDOWED_SINC:
+			this->processModulatedWithQuality<BLEPQuality::WINDOWED_SINC>( writeBuffer, numSamples, modulation );
+			break;
+		case BLEPQuality::POLYNOMIAL:
+		default:
+			this->processModulatedWithQuality<BLEPQuality::POLYNOMIAL>( writeBuffer, numSamples, modulation );
 	}
 }
 
@@ -146,7 +508,12 @@ void PolyBLEPOsc::applyTriangleFilter()
 	m_A0 = 1.0f - m_B1;
 }
 
+void PolyBLEPOsc::setSineTableSize (const unsigned int size)
+{
+	m_SineTable.store( Wavetable::getSineTable(size).get(), std::memory_order_release );
+}
+
 void PolyBLEPOsc::resetPhase()
 {
-	m_Phase = 0.0f;
+	m_Phase = 0;
 }
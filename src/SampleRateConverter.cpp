@@ -1,416 +1,1144 @@
 #include "SampleRateConverter.hpp"
 
+#include "FIRKernels.hpp"
+
+#define _USE_MATH_DEFINES
+
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#if ! defined(TARGET_BUILD)
+#include <thread>
+#endif // TARGET_BUILD
 
+// the sample type conversions don't depend on the number of channels, so they're kept out of the class
 template <typename SType, typename TType>
-SampleRateConverter<SType, TType>::SampleRateConverter (const unsigned int initialSourceRate, const unsigned int initialTargetRate,
-							const unsigned int initialSourceBufferSize) :
+struct SampleTypeConversion;
+
+template <>
+struct SampleTypeConversion<float, float>
+{
+	static constexpr float sourceToTarget (float sourceType) { return sourceType; }
+	static constexpr float targetToSource (float targetType) { return targetType; }
+	static constexpr float targetZeroPoint() { return 0.0f; }
+	static constexpr float sourceZeroPoint() { return 0.0f; }
+};
+
+template <>
+struct SampleTypeConversion<float, uint16_t>
+{
+	static constexpr uint16_t sourceToTarget (float sourceType) { return static_cast<uint16_t>( (sourceType + 1.0f) * 32767.0f ); }
+	static constexpr float targetToSource (uint16_t targetType) { return static_cast<float>( targetType - 32768 ) * ( 1.0f / 32768.0f ); }
+	static constexpr uint16_t targetZeroPoint() { return 32767; }
+	static constexpr float sourceZeroPoint() { return 0.0f; }
+};
+
+template <>
+struct SampleTypeConversion<float, int16_t>
+{
+	static constexpr int16_t sourceToTarget (float sourceType) { return static_cast<int16_t>( sourceType * 32767.0f ); }
+	static constexpr float targetToSource (int16_t targetType) { return static_cast<float>( targetType ) * ( 1.0f / 32768.0f ); }
+	static constexpr int16_t targetZeroPoint() { return 0; }
+	static constexpr float sourceZeroPoint() { return 0.0f; }
+};
+
+// returns 1 if both are 0, so it's always safe to divide by
+static unsigned int greatestCommonDivisor (const unsigned int a, const unsigned int b)
+{
+	unsigned int divisor = a;
+	unsigned int remainder = b;
+	while ( remainder != 0 )
+	{
+		const unsigned int nextRemainder = divisor % remainder;
+		divisor = remainder;
+		remainder = nextRemainder;
+	}
+
+	return ( divisor != 0 ) ? divisor : 1;
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+SampleRateConverter<SType, TType, numChannels>::SampleRateConverter (const unsigned int initialSourceRate, const unsigned int initialTargetRate,
+							const unsigned int initialSourceBufferSize, const unsigned int aaFilterOrder,
+							const FilterWindow aaFilterWindow, const float aaFilterKaiserBeta,
+							const FilterPhase aaFilterPhase) :
 	m_SourceRate( initialSourceRate ),
 	m_TargetRate( initialTargetRate ),
 	m_SourceBufferSize( initialSourceBufferSize ),
 	m_TargetBufferSize( getTargetBufferSizePerSourceBuffer() ),
-	m_SourceToTargetSourceIncr( 0.0f ),
-	m_SourceToTargetTargetIncr( 0.0f ),
-	m_TargetToSourceTargetIncr( -1.0f ), // since we begin delayed by one target sample
-	m_TargetToSourceSourceIncr( 0.0f ),
-	m_TargetToSourceEmittedSamples(),
-	m_WorkingTargetBufferLastSample( getTargetZeroPoint() ),
-	m_WorkingSourceBufferLastSample( getSourceZeroPoint() ),
-	m_SourceToTargetDownsamplingAAFilter(
-			// cutoff
-			m_TargetRate / 2,
-			// sample rate
-			m_SourceRate,
-			// filter order
-			63 ),
-	m_SourceToTargetUpsamplingAAFilter(
-			// cutoff
-			m_TargetRate / 2,
-			// sample rate
-			m_TargetRate,
-			// filter order
-			63 ),
-	m_TargetToSourceDownsamplingAAFilter(
-			// cutoff
-			m_SourceRate / 2,
-			// sample rate
-			m_TargetRate,
-			// filter order
-			63 ),
-	m_TargetToSourceUpsamplingAAFilter(
-			// cutoff
-			m_SourceRate / 2,
-			// sample rate
-			m_SourceRate,
-			// filter order
-			63 )
-{
-	// if downsampling from source to target, we'll be on the tail end of each "sample", so we set the source incr to be too
-	if ( ! sourceToTargetIsUpsampling() )
-	{
-		const float sourceSamplesPerTargetSample = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
-		m_TargetToSourceSourceIncr = sourceSamplesPerTargetSample;
+	m_SourceToTargetSourceIncr( 0 ),
+	m_SourceToTargetSourceIncrFrac( 0 ),
+	m_SourceToTargetTargetIncr( 0 ),
+	m_TargetToSourceTargetIncr( -1 ), // since we begin delayed by one target sample
+	m_TargetToSourceTargetIncrFrac( 0 ),
+	m_TargetToSourceSourceIncr( 0 ),
+	m_SourceToTargetStep( 0 ),
+	m_SourceToTargetStepFrac( 0 ),
+	m_SourceToTargetFracDenominator( 1 ),
+	m_SourceToTargetFracScale( 1.0f ),
+	m_TargetToSourceStep( 0 ),
+	m_TargetToSourceStepFrac( 0 ),
+	m_TargetToSourceFracDenominator( 1 ),
+	m_TargetToSourceFracScale( 1.0f ),
+	m_Asynchronous( false ),
+	m_Drift( 0.0f ),
+	m_MaxDrift( SRC_DEFAULT_MAX_DRIFT ),
+	m_DriftControlTime( SRC_DEFAULT_DRIFT_CONTROL_TIME ),
+	m_MeasuredDrift( 0.0f ),
+	m_FillLevelDrift( 0.0f ),
+	m_FillLevelErrorIntegral( 0.0f ),
+	m_TargetFillLevel( 0.0f ),
+	m_SmoothedFillLevel( 0.0f ),
+	m_FillLevelIsValid( false ),
+	m_TargetToSourceCarry(),
+	m_TargetToSourceCarryFrames( 0 ),
+	m_TargetToSourceCarryStart( 0 ),
+	m_TargetToSourceCarryCount( 0 ),
+	m_InterpolationQuality( InterpolationQuality::LINEAR ),
+	m_HistoryLength( 1 ),
+	m_SourceWorkingBuffer(),
+	m_TargetWorkingBuffer(),
+	m_SourceToTargetSincTable(),
+	m_TargetToSourceSincTable(),
+	m_AAFilterOrder( aaFilterOrder ),
+	m_AAFilterWindow( aaFilterWindow ),
+	m_AAFilterKaiserBeta( aaFilterKaiserBeta ),
+	m_AAFilterPhase( aaFilterPhase ),
+	m_SourceToTargetDownsamplingAAFilters( numChannels, AntiAliasingFilter<SType>(
+				// cutoff
+				m_TargetRate / 2,
+				// sample rate
+				m_SourceRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase ) ),
+	m_SourceToTargetUpsamplingAAFilters( numChannels, AntiAliasingFilter<TType>(
+				// cutoff
+				m_SourceRate / 2,
+				// sample rate
+				m_TargetRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase ) ),
+	m_TargetToSourceDownsamplingAAFilters( numChannels, AntiAliasingFilter<TType>(
+				// cutoff
+				m_SourceRate / 2,
+				// sample rate
+				m_TargetRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase ) ),
+	m_TargetToSourceUpsamplingAAFilters( numChannels, AntiAliasingFilter<SType>(
+				// cutoff
+				m_TargetRate / 2,
+				// sample rate
+				m_SourceRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase ) )
+{
+	this->calculatePhaseSteps();
+	this->resetPhase();
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromSourceToTargetDownsampling (const SType* const sourceBuffer, TType* const targetBuffer)
+{
+	return this->convertFromSourceToTarget( sourceBuffer, targetBuffer );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromSourceToTargetUpsampling (const SType* const sourceBuffer, TType* const targetBuffer)
+{
+	return this->convertFromSourceToTarget( sourceBuffer, targetBuffer );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromTargetToSourceUpsampling (const TType* const targetBuffer,
+											const unsigned int targetBufferSize,
+											SType* const sourceBuffer)
+{
+	return this->convertFromTargetToSource( targetBuffer, targetBufferSize, sourceBuffer );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromTargetToSourceDownsampling (const TType* const targetBuffer,
+											const unsigned int targetBufferSize,
+											SType* const sourceBuffer)
+{
+	return this->convertFromTargetToSource( targetBuffer, targetBufferSize, sourceBuffer );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromSourceToTarget (const SType* const sourceBuffer, TType* const targetBuffer)
+{
+	switch ( m_InterpolationQuality )
+	{
+		case InterpolationQuality::HERMITE:
+			return this->template convertFromSourceToTargetWithQuality<InterpolationQuality::HERMITE>( sourceBuffer, targetBuffer );
+		case InterpolationQuality::SINC:
+			return this->template convertFromSourceToTargetWithQuality<InterpolationQuality::SINC>( sourceBuffer, targetBuffer );
+		case InterpolationQuality::LINEAR:
+		default:
+			return this->template convertFromSourceToTargetWithQuality<InterpolationQuality::LINEAR>( sourceBuffer, targetBuffer );
 	}
 }
 
-template <typename SType, typename TType>
-unsigned int SampleRateConverter<SType, TType>::convertFromSourceToTargetDownsampling (const SType* const sourceBuffer, TType* const targetBuffer)
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromTargetToSource (const TType* const targetBuffer, const unsigned int targetBufferSize,
+										SType* const sourceBuffer)
 {
-	const float sourceSamplesPerTargetSample = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
+	m_TargetToSourceSourceIncr = 0;
+
+	// we may need to fill this buffer with frames generated from the last buffer if the buffer size is fractional
+	while ( m_TargetToSourceCarryCount > 0 && m_TargetToSourceSourceIncr < m_SourceBufferSize )
+	{
+		std::copy( &m_TargetToSourceCarry[m_TargetToSourceCarryStart * numChannels],
+				&m_TargetToSourceCarry[(m_TargetToSourceCarryStart + 1) * numChannels],
+				&sourceBuffer[m_TargetToSourceSourceIncr * numChannels] );
+		m_TargetToSourceSourceIncr++;
+
+		m_TargetToSourceCarryStart = ( m_TargetToSourceCarryStart + 1 ) % m_TargetToSourceCarryFrames;
+		m_TargetToSourceCarryCount--;
+	}
 
+	// the working buffer has room for the target buffer size per source buffer, so larger buffers are converted in pieces
+	// instead of growing it on the audio thread
+	const unsigned int maxPieceSize = ( m_TargetWorkingBuffer.size() / numChannels ) - m_HistoryLength;
 	unsigned int samplesConverted = 0;
 
+	for ( unsigned int pieceStart = 0; pieceStart < targetBufferSize; pieceStart += maxPieceSize )
+	{
+		const TType* const piece = &targetBuffer[pieceStart * numChannels];
+		const unsigned int pieceSize = std::min( targetBufferSize - pieceStart, maxPieceSize );
+
+		switch ( m_InterpolationQuality )
+		{
+			case InterpolationQuality::HERMITE:
+				samplesConverted += this->template convertFromTargetToSourceWithQuality<InterpolationQuality::HERMITE>( piece, pieceSize,
+																	sourceBuffer );
+				break;
+			case InterpolationQuality::SINC:
+				samplesConverted += this->template convertFromTargetToSourceWithQuality<InterpolationQuality::SINC>( piece, pieceSize,
+																	sourceBuffer );
+				break;
+			case InterpolationQuality::LINEAR:
+			default:
+				samplesConverted += this->template convertFromTargetToSourceWithQuality<InterpolationQuality::LINEAR>( piece, pieceSize,
+																	sourceBuffer );
+		}
+	}
+
+	return samplesConverted;
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+template <InterpolationQuality quality>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromSourceToTargetWithQuality (const SType* const sourceBuffer, TType* const targetBuffer)
+{
+	constexpr unsigned int numPoints = getInterpolationPoints( quality );
+	float weights[numPoints];
+	float frame[numChannels];
+
+	// copy this buffer in after the end of the previous one
+	float* const workingBuffer = m_SourceWorkingBuffer.data();
+	const unsigned int historySize = m_HistoryLength * numChannels;
+	const unsigned int sourceBufferSize = m_SourceBufferSize * numChannels;
+	for ( unsigned int sample = 0; sample < sourceBufferSize; sample++ )
+	{
+		workingBuffer[historySize + sample] = static_cast<float>( sourceBuffer[sample] );
+	}
+
 	// to keep sampling consistent, we need the modulo value for the next source buffer
-	m_SourceToTargetSourceIncr = std::fmod( m_SourceToTargetSourceIncr, m_SourceBufferSize );
-	m_SourceToTargetTargetIncr = 0.0f;
+	m_SourceToTargetSourceIncr = m_SourceToTargetSourceIncr % m_SourceBufferSize;
+	m_SourceToTargetTargetIncr = 0;
 
-	// we may need to linearly interpolate between the first sample of this buffer and the last sample of the previous buffer
-	if ( m_SourceToTargetSourceIncr < 1.0f )
+	// the source position is delayed by the history length, so the newest interpolation point is always in this buffer
+	while ( m_SourceToTargetSourceIncr < m_SourceBufferSize )
 	{
-		// linearly interpolate
-		const float fraction = std::fmod( m_SourceToTargetSourceIncr, 1.0f );
-		const float lowerAmt = 1.0f - fraction;
-		const float upperAmt = 1.0f - lowerAmt;
-		const float lowerSourceBufferVal = m_WorkingSourceBufferLastSample;
-		const float upperSourceBufferVal = sourceBuffer[ static_cast<unsigned int>(std::floor(m_SourceToTargetSourceIncr)) ];
-		const float lowerVal = lowerAmt * lowerSourceBufferVal;
-		const float upperVal = upperAmt * upperSourceBufferVal;
-		const SType sampleVal = static_cast<SType>( lowerVal + upperVal );
+		const float fraction = static_cast<float>( m_SourceToTargetSourceIncrFrac ) * m_SourceToTargetFracScale;
+		calculateWeights<quality>( fraction, m_SourceToTargetSincTable, weights );
+		applyWeights<numPoints>( &workingBuffer[m_SourceToTargetSourceIncr * numChannels], weights, frame );
 
-		targetBuffer[0] = convertSourceToTargetType( sampleVal );
-		m_SourceToTargetTargetIncr += 1.0f;
+		TType* const targetFrame = &targetBuffer[m_SourceToTargetTargetIncr * numChannels];
+		for ( unsigned int channel = 0; channel < numChannels; channel++ )
+		{
+			targetFrame[channel] = convertSourceToTargetType( static_cast<SType>(frame[channel]) );
+		}
+		m_SourceToTargetTargetIncr++;
 
-		m_SourceToTargetSourceIncr += sourceSamplesPerTargetSample;
+		advancePhase( m_SourceToTargetSourceIncr, m_SourceToTargetSourceIncrFrac, m_SourceToTargetStep, m_SourceToTargetStepFrac,
+				m_SourceToTargetFracDenominator );
+	}
 
-		samplesConverted++;
+	// save the end of this buffer in case the next buffer needs it
+	std::copy( &workingBuffer[sourceBufferSize], &workingBuffer[sourceBufferSize + historySize], &workingBuffer[0] );
+
+	return m_SourceToTargetTargetIncr;
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+template <InterpolationQuality quality>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromTargetToSourceWithQuality (const TType* const targetBuffer,
+											const unsigned int targetBufferSize,
+											SType* const sourceBuffer)
+{
+	constexpr unsigned int numPoints = getInterpolationPoints( quality );
+	float weights[numPoints];
+	float frame[numChannels];
+	unsigned int samplesConverted = 0;
+
+	// copy this buffer in after the end of the previous one
+	float* const workingBuffer = m_TargetWorkingBuffer.data();
+	const unsigned int historySize = m_HistoryLength * numChannels;
+	const unsigned int targetBufferSamples = targetBufferSize * numChannels;
+	for ( unsigned int sample = 0; sample < targetBufferSamples; sample++ )
+	{
+		workingBuffer[historySize + sample] = static_cast<float>( targetBuffer[sample] );
 	}
 
-	// buffer incr - 1.0f because we need valid indices and we're essentially delaying by one sample
-	for ( float& sample = m_SourceToTargetTargetIncr; m_SourceToTargetSourceIncr < m_SourceBufferSize; sample += 1.0f )
+	// the target position is delayed by one sample, so positions between -1 and 0 fall between the last sample of the previous
+	// buffer and the first sample of this one (with any extra history the interpolation needs before that)
+	const int lastTargetIndex = static_cast<int>( targetBufferSize ) - 1;
+	while ( m_TargetToSourceTargetIncr < lastTargetIndex )
 	{
+		const float fraction = static_cast<float>( m_TargetToSourceTargetIncrFrac ) * m_TargetToSourceFracScale;
+		calculateWeights<quality>( fraction, m_TargetToSourceSincTable, weights );
+		applyWeights<numPoints>( &workingBuffer[(m_TargetToSourceTargetIncr + 1) * static_cast<int>(numChannels)], weights, frame );
 
-		// linearly interpolate
-		const float fraction = std::fmod( m_SourceToTargetSourceIncr, 1.0f );
-		const float lowerAmt = 1.0f - fraction;
-		const float upperAmt = 1.0f - lowerAmt;
-		const float lowerSourceBufferVal = sourceBuffer[ static_cast<unsigned int>(std::floor(m_SourceToTargetSourceIncr - 1.0f)) ];
-		const float upperSourceBufferVal = sourceBuffer[ static_cast<unsigned int>(std::ceil(m_SourceToTargetSourceIncr - 1.0f)) ];
-		const float lowerVal = lowerAmt * lowerSourceBufferVal;
-		const float upperVal = upperAmt * upperSourceBufferVal;
-		const SType sampleVal = static_cast<SType>( lowerVal + upperVal );
+		// we may be emitting frames that don't fit in this source buffer if the target buffer size is fractional
+		SType* sourceFrame = nullptr;
+		if ( m_TargetToSourceSourceIncr >= m_SourceBufferSize )
+		{
+			// the carry is sized so this can only fill up if the target buffers don't keep up with the target rate, in which
+			// case the extra frames are dropped
+			if ( m_TargetToSourceCarryCount < m_TargetToSourceCarryFrames )
+			{
+				const unsigned int carryIndex = ( m_TargetToSourceCarryStart + m_TargetToSourceCarryCount )
+									% m_TargetToSourceCarryFrames;
+				sourceFrame = &m_TargetToSourceCarry[carryIndex * numChannels];
+				m_TargetToSourceCarryCount++;
+			}
+		}
+		else
+		{
+			sourceFrame = &sourceBuffer[m_TargetToSourceSourceIncr * numChannels];
+			m_TargetToSourceSourceIncr++;
+		}
 
-		targetBuffer[ static_cast<unsigned int>(sample) ] = convertSourceToTargetType( sampleVal );
+		if ( sourceFrame )
+		{
+			for ( unsigned int channel = 0; channel < numChannels; channel++ )
+			{
+				sourceFrame[channel] = convertTargetToSourceType( static_cast<TType>(frame[channel]) );
+			}
+		}
 
-		m_SourceToTargetSourceIncr += sourceSamplesPerTargetSample;
+		advancePhase( m_TargetToSourceTargetIncr, m_TargetToSourceTargetIncrFrac, m_TargetToSourceStep, m_TargetToSourceStepFrac,
+				m_TargetToSourceFracDenominator );
 
 		samplesConverted++;
 	}
 
-	// save last sample value in case the next buffer needs it
-	const unsigned int lastSampleIndex = m_SourceBufferSize - 1;
-	m_WorkingSourceBufferLastSample = sourceBuffer[ lastSampleIndex ];
+	// the next buffer starts where this one left off, minus one since we want to use this buffer's last sample
+	m_TargetToSourceTargetIncr -= static_cast<int>( targetBufferSize );
+
+	// save the end of this buffer in case the next buffer needs it
+	std::copy( &workingBuffer[targetBufferSamples], &workingBuffer[targetBufferSamples + historySize], &workingBuffer[0] );
 
 	return samplesConverted;
 }
 
-template <typename SType, typename TType>
-unsigned int SampleRateConverter<SType, TType>::convertFromTargetToSourceUpsampling (const TType* const targetBuffer,
-											const unsigned int targetBufferSize,
-											SType* const sourceBuffer)
+template <typename SType, typename TType, unsigned int numChannels>
+template <InterpolationQuality quality>
+void SampleRateConverter<SType, TType, numChannels>::calculateWeights (const float fraction, const std::vector<float>& sincTable,
+										float* const weights)
 {
-	const float targetSamplesPerSourceSample = static_cast<float>( m_TargetRate ) / static_cast<float>( m_SourceRate );
+	switch ( quality )
+	{
+		case InterpolationQuality::HERMITE:
+		{
+			// 4-point, 3rd-order hermite (catmull-rom), expanded into the weight of each point
+			const float fraction2 = fraction * fraction;
+			const float fraction3 = fraction2 * fraction;
 
-	unsigned int samplesConverted = 0;
+			weights[0] = ( -0.5f * fraction3 ) + fraction2 - ( 0.5f * fraction );
+			weights[1] = ( 1.5f * fraction3 ) - ( 2.5f * fraction2 ) + 1.0f;
+			weights[2] = ( -1.5f * fraction3 ) + ( 2.0f * fraction2 ) + ( 0.5f * fraction );
+			weights[3] = ( 0.5f * fraction3 ) - ( 0.5f * fraction2 );
 
-	// samples that are generated, but to be used in the next source buffer since they don't fit in this one
-	unsigned int samplesEmitted = 0;
+			break;
+		}
+		case InterpolationQuality::SINC:
+		{
+			// each row of the table is the kernel for one phase, we interpolate between the two closest rows
+			const float phase = fraction * static_cast<float>( SRC_SINC_PHASES );
+			const unsigned int phaseIndex = std::min( static_cast<unsigned int>(phase), SRC_SINC_PHASES - 1 );
+			const float phaseFraction = phase - static_cast<float>( phaseIndex );
+			const float* const lowerKernel = &sincTable[phaseIndex * SRC_SINC_TAPS];
+			const float* const upperKernel = &sincTable[(phaseIndex + 1) * SRC_SINC_TAPS];
+
+			for ( unsigned int tap = 0; tap < SRC_SINC_TAPS; tap++ )
+			{
+				weights[tap] = ( (1.0f - phaseFraction) * lowerKernel[tap] ) + ( phaseFraction * upperKernel[tap] );
+			}
+
+			break;
+		}
+		case InterpolationQuality::LINEAR:
+		default:
+			weights[0] = 1.0f - fraction;
+			weights[1] = fraction;
+	}
+}
 
-	m_TargetToSourceSourceIncr = 0.0f;
+template <typename SType, typename TType, unsigned int numChannels>
+template <unsigned int numPoints>
+void SampleRateConverter<SType, TType, numChannels>::applyWeights (const float* const points, const float* const weights, float* const frame)
+{
+	// a single channel of sinc taps is long enough to be worth the simd kernels
+	if ( numChannels == 1 && numPoints >= SRC_SINC_TAPS )
+	{
+		frame[0] = firDotProduct( points, weights, numPoints );
+		return;
+	}
 
-	// we may need to fill this buffer with samples generated from the last buffer if the buffer size is fractional
-	for ( const SType sampleVal : m_TargetToSourceEmittedSamples )
+	// the channel loop is innermost so it can be vectorized across the frame
+	for ( unsigned int channel = 0; channel < numChannels; channel++ )
 	{
-		sourceBuffer[ static_cast<unsigned int>(m_TargetToSourceSourceIncr) ] = sampleVal;
+		frame[channel] = 0.0f;
+	}
+	for ( unsigned int point = 0; point < numPoints; point++ )
+	{
+		const float weight = weights[point];
+		const float* const pointFrame = &points[point * numChannels];
 
-		m_TargetToSourceSourceIncr += 1.0f;
-		m_TargetToSourceTargetIncr += targetSamplesPerSourceSample;
+		for ( unsigned int channel = 0; channel < numChannels; channel++ )
+		{
+			frame[channel] += weight * pointFrame[channel];
+		}
 	}
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromSourceToTargetOffline (const SType* const sourceBuffer,
+											const unsigned int numSourceFrames,
+											TType* const targetBuffer,
+											const unsigned int numThreads) const
+{
+	const unsigned int divisor = greatestCommonDivisor( m_SourceRate, m_TargetRate );
+	const bool useFilters = ( m_InterpolationQuality != InterpolationQuality::SINC );
+
+	OfflineConversion<SType, TType> conversion;
+	conversion.input = sourceBuffer;
+	conversion.numInputFrames = numSourceFrames;
+	conversion.output = targetBuffer;
+	conversion.numOutputFrames = this->getOfflineTargetFrames( numSourceFrames );
+	conversion.inputRateReduced = m_SourceRate / divisor;
+	conversion.outputRateReduced = m_TargetRate / divisor;
+	conversion.sincTable = &m_SourceToTargetSincTable;
+	conversion.inputZeroPoint = SampleTypeConversion<SType, TType>::sourceZeroPoint();
+	conversion.convert = SampleTypeConversion<SType, TType>::sourceToTarget;
+	conversion.usePreFilter = useFilters && ! this->sourceToTargetIsUpsampling();
+	conversion.preFilterCutoff = m_TargetRate / 2;
+	conversion.preFilterRate = m_SourceRate;
+	conversion.usePostFilter = useFilters && this->sourceToTargetIsUpsampling();
+	conversion.postFilterCutoff = m_SourceRate / 2;
+	conversion.postFilterRate = m_TargetRate;
+
+	return this->convertOffline( conversion, numThreads );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertFromTargetToSourceOffline (const TType* const targetBuffer,
+											const unsigned int numTargetFrames,
+											SType* const sourceBuffer,
+											const unsigned int numThreads) const
+{
+	const unsigned int divisor = greatestCommonDivisor( m_SourceRate, m_TargetRate );
+	const bool useFilters = ( m_InterpolationQuality != InterpolationQuality::SINC );
+
+	OfflineConversion<TType, SType> conversion;
+	conversion.input = targetBuffer;
+	conversion.numInputFrames = numTargetFrames;
+	conversion.output = sourceBuffer;
+	conversion.numOutputFrames = this->getOfflineSourceFrames( numTargetFrames );
+	conversion.inputRateReduced = m_TargetRate / divisor;
+	conversion.outputRateReduced = m_SourceRate / divisor;
+	conversion.sincTable = &m_TargetToSourceSincTable;
+	conversion.inputZeroPoint = SampleTypeConversion<SType, TType>::targetZeroPoint();
+	conversion.convert = SampleTypeConversion<SType, TType>::targetToSource;
+	conversion.usePreFilter = useFilters && ! this->targetToSourceIsUpsampling();
+	conversion.preFilterCutoff = m_SourceRate / 2;
+	conversion.preFilterRate = m_TargetRate;
+	conversion.usePostFilter = useFilters && this->targetToSourceIsUpsampling();
+	conversion.postFilterCutoff = m_TargetRate / 2;
+	conversion.postFilterRate = m_SourceRate;
+
+	return this->convertOffline( conversion, numThreads );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::getOfflineTargetFrames (const unsigned int numSourceFrames) const
+{
+	// streaming emits a target frame for every position that falls inside the source frames
+	const uint64_t divisor = greatestCommonDivisor( m_SourceRate, m_TargetRate );
+	const uint64_t sourceRateReduced = m_SourceRate / divisor;
+	const uint64_t targetRateReduced = m_TargetRate / divisor;
+
+	return static_cast<unsigned int>( ((numSourceFrames * targetRateReduced) + sourceRateReduced - 1) / sourceRateReduced );
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+unsigned int SampleRateConverter<SType, TType, numChannels>::getOfflineSourceFrames (const unsigned int numTargetFrames) const
+{
+	const uint64_t divisor = greatestCommonDivisor( m_SourceRate, m_TargetRate );
+	const uint64_t sourceRateReduced = m_SourceRate / divisor;
+	const uint64_t targetRateReduced = m_TargetRate / divisor;
+
+	return static_cast<unsigned int>( ((numTargetFrames * sourceRateReduced) + targetRateReduced - 1) / targetRateReduced );
+}
 
-	// clear emitted samples since they've been used and we may emit new samples for this buffer
-	m_TargetToSourceEmittedSamples.clear();
+template <typename SType, typename TType, unsigned int numChannels>
+template <typename InType, typename OutType>
+unsigned int SampleRateConverter<SType, TType, numChannels>::convertOffline (const OfflineConversion<InType, OutType>& conversion,
+										const unsigned int numThreads) const
+{
+	const unsigned int numChunks = ( conversion.numOutputFrames + SRC_OFFLINE_CHUNK_FRAMES - 1 ) / SRC_OFFLINE_CHUNK_FRAMES;
+	std::atomic<unsigned int> nextChunk( 0 );
 
-	// we may need to linearly interpolate between the first sample of this buffer and the last sample of the previous buffer
-	for ( float& sample = m_TargetToSourceTargetIncr; sample < 0.0f; sample += targetSamplesPerSourceSample )
+	// each worker takes the next chunk until there are none left
+	auto worker = [this, &conversion, &nextChunk, numChunks]()
 	{
-		// this value should be between 0 and 1
-		const float tempTargetToSourceTargetIncr = sample + 1.0f;
+		std::vector<InType> inputScratch;
+		std::vector<float> pointScratch;
+		std::vector<OutType> outputScratch;
 
-		// linearly interpolate
-		const float fraction = std::fmod( tempTargetToSourceTargetIncr, 1.0f );
-		const float lowerAmt = 1.0f - fraction;
-		const float upperAmt = 1.0f - lowerAmt;
-		const float lowerTargetBufferVal = m_WorkingTargetBufferLastSample;
-		const float upperTargetBufferVal = targetBuffer[ static_cast<unsigned int>(std::floor(tempTargetToSourceTargetIncr)) ];
-		const float lowerVal = lowerAmt * lowerTargetBufferVal;
-		const float upperVal = upperAmt * upperTargetBufferVal;
-		const TType sampleVal = static_cast<TType>( lowerVal + upperVal );
+		for ( unsigned int chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++ )
+		{
+			const unsigned int firstFrame = chunk * SRC_OFFLINE_CHUNK_FRAMES;
+			const unsigned int lastFrame = std::min( firstFrame + SRC_OFFLINE_CHUNK_FRAMES, conversion.numOutputFrames );
+
+			switch ( m_InterpolationQuality )
+			{
+				case InterpolationQuality::HERMITE:
+					this->template convertOfflineChunk<InterpolationQuality::HERMITE>( conversion, firstFrame, lastFrame,
+										inputScratch, pointScratch, outputScratch );
+					break;
+				case InterpolationQuality::SINC:
+					this->template convertOfflineChunk<InterpolationQuality::SINC>( conversion, firstFrame, lastFrame,
+										inputScratch, pointScratch, outputScratch );
+					break;
+				case InterpolationQuality::LINEAR:
+				default:
+					this->template convertOfflineChunk<InterpolationQuality::LINEAR>( conversion, firstFrame, lastFrame,
+										inputScratch, pointScratch, outputScratch );
+			}
+		}
+	};
+
+#if defined(TARGET_BUILD)
+	// there are no threads on the target, so the chunks are converted one after another
+	(void) numThreads;
+	worker();
+#else
+	const unsigned int hardwareThreads = std::max( std::thread::hardware_concurrency(), 1u );
+	const unsigned int numWorkers = std::min( (numThreads == 0) ? hardwareThreads : numThreads, std::max(numChunks, 1u) );
+
+	// the calling thread is one of the workers
+	std::vector<std::thread> threads;
+	for ( unsigned int thread = 1; thread < numWorkers; thread++ )
+	{
+		threads.emplace_back( worker );
+	}
+	worker();
+	for ( std::thread& thread : threads )
+	{
+		thread.join();
+	}
+#endif // TARGET_BUILD
 
-		sourceBuffer[ static_cast<unsigned int>(m_TargetToSourceSourceIncr) ] = convertTargetToSourceType( sampleVal );
+	return conversion.numOutputFrames;
+}
 
-		m_TargetToSourceSourceIncr += 1.0f;
+template <typename SType, typename TType, unsigned int numChannels>
+template <InterpolationQuality quality, typename InType, typename OutType>
+void SampleRateConverter<SType, TType, numChannels>::convertOfflineChunk (const OfflineConversion<InType, OutType>& conversion,
+										const unsigned int firstFrame, const unsigned int lastFrame,
+										std::vector<InType>& inputScratch,
+										std::vector<float>& pointScratch,
+										std::vector<OutType>& outputScratch) const
+{
+	constexpr unsigned int numPoints = getInterpolationPoints( quality );
+	constexpr unsigned int historyLength = numPoints - 1;
+	float weights[numPoints];
+	float frame[numChannels];
+
+	// the post filter is warmed up on the output frames before the chunk, which come out the same as they would while streaming
+	const unsigned int filterWarmUp = m_AAFilterOrder;
+	const unsigned int startFrame = ( conversion.usePostFilter ) ? firstFrame - std::min( firstFrame, filterWarmUp ) : firstFrame;
+
+	// positions are in the input with the streaming path's silent history in front of it, so output frame n interpolates the
+	// points from position(n) to position(n) + historyLength
+	const uint64_t inputRate = conversion.inputRateReduced;
+	const uint64_t outputRate = conversion.outputRateReduced;
+	const float fracScale = 1.0f / static_cast<float>( conversion.outputRateReduced );
+	const unsigned int firstPoint = static_cast<unsigned int>( (startFrame * inputRate) / outputRate );
+	const unsigned int lastPoint = static_cast<unsigned int>( ((lastFrame - 1) * inputRate) / outputRate ) + historyLength;
+
+	// the input frames the points need, and the ones before them that warm up the pre filter
+	const int firstInputFrame = static_cast<int>( firstPoint ) - static_cast<int>( historyLength );
+	const unsigned int lastInputFrame = lastPoint - historyLength;
+	const unsigned int inputWarmUp = ( conversion.usePreFilter ) ? filterWarmUp : 0;
+	const unsigned int inputStart = static_cast<unsigned int>( std::max(firstInputFrame - static_cast<int>(inputWarmUp), 0) );
+
+	inputScratch.assign( &conversion.input[inputStart * numChannels], &conversion.input[(lastInputFrame + 1) * numChannels] );
+	if ( conversion.usePreFilter )
+	{
+		for ( unsigned int channel = 0; channel < numChannels; channel++ )
+		{
+			AntiAliasingFilter<InType> filter( conversion.preFilterCutoff, conversion.preFilterRate, m_AAFilterOrder, m_AAFilterWindow,
+								m_AAFilterKaiserBeta, m_AAFilterPhase );
+			filter.call( &inputScratch[channel], lastInputFrame + 1 - inputStart, numChannels );
+		}
+	}
 
-		samplesConverted++;
+	const unsigned int numPointFrames = lastPoint + 1 - firstPoint;
+	pointScratch.resize( numPointFrames * numChannels );
+	for ( unsigned int point = 0; point < numPointFrames; point++ )
+	{
+		const int inputFrame = static_cast<int>( firstPoint + point ) - static_cast<int>( historyLength );
+
+		for ( unsigned int channel = 0; channel < numChannels; channel++ )
+		{
+			pointScratch[(point * numChannels) + channel] = ( inputFrame < 0 ) ? static_cast<float>( conversion.inputZeroPoint )
+							: static_cast<float>( inputScratch[((inputFrame - inputStart) * numChannels) + channel] );
+		}
 	}
 
-	for ( float& sample = m_TargetToSourceTargetIncr;
-			sample < static_cast<float>(targetBufferSize - 1);
-			sample += targetSamplesPerSourceSample )
+	outputScratch.resize( (lastFrame - startFrame) * numChannels );
+	for ( unsigned int outputFrame = startFrame; outputFrame < lastFrame; outputFrame++ )
 	{
-		// linearly interpolate
-		const float fraction = std::fmod( m_TargetToSourceTargetIncr, 1.0f );
-		const float lowerAmt = 1.0f - fraction;
-		const float upperAmt = 1.0f - lowerAmt;
-		const float lowerTargetBufferVal = targetBuffer[ static_cast<unsigned int>(std::floor(m_TargetToSourceTargetIncr)) ];
-		const float upperTargetBufferVal = targetBuffer[ static_cast<unsigned int>(std::ceil(m_TargetToSourceTargetIncr)) ];
-		const float lowerVal = lowerAmt * lowerTargetBufferVal;
-		const float upperVal = upperAmt * upperTargetBufferVal;
-		const TType sampleVal = static_cast<TType>( lowerVal + upperVal );
+		// each position is calculated exactly, which is what the streaming phase accumulator arrives at
+		const uint64_t position = outputFrame * inputRate;
+		const unsigned int point = static_cast<unsigned int>( position / outputRate ) - firstPoint;
+		const float fraction = static_cast<float>( static_cast<unsigned int>(position % outputRate) ) * fracScale;
+
+		calculateWeights<quality>( fraction, *conversion.sincTable, weights );
+		applyWeights<numPoints>( &pointScratch[point * numChannels], weights, frame );
 
-		// we may be emitting samples that don't fit in this source buffer if the target buffer size is fractional
-		if ( m_TargetToSourceSourceIncr > static_cast<float>(m_SourceBufferSize - 1) )
+		OutType* const outputFrameSamples = &outputScratch[(outputFrame - startFrame) * numChannels];
+		for ( unsigned int channel = 0; channel < numChannels; channel++ )
 		{
-			m_TargetToSourceEmittedSamples.push_back( convertTargetToSourceType(sampleVal) );
-			samplesEmitted++;
+			outputFrameSamples[channel] = conversion.convert( static_cast<InType>(frame[channel]) );
 		}
-		else
+	}
+
+	if ( conversion.usePostFilter )
+	{
+		for ( unsigned int channel = 0; channel < numChannels; channel++ )
 		{
-			sourceBuffer[ static_cast<unsigned int>(m_TargetToSourceSourceIncr) ] = convertTargetToSourceType( sampleVal );
+			AntiAliasingFilter<OutType> filter( conversion.postFilterCutoff, conversion.postFilterRate, m_AAFilterOrder,
+								m_AAFilterWindow, m_AAFilterKaiserBeta, m_AAFilterPhase );
+			filter.call( &outputScratch[channel], lastFrame - startFrame, numChannels );
 		}
+	}
 
-		m_TargetToSourceSourceIncr += 1.0f;
+	std::copy( outputScratch.begin() + ((firstFrame - startFrame) * numChannels), outputScratch.end(),
+			&conversion.output[firstFrame * numChannels] );
+}
 
-		samplesConverted++;
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::filterSourceToTargetDownsampling (SType* const buffer)
+{
+	// the sinc interpolation already band limits the signal
+	if ( m_InterpolationQuality == InterpolationQuality::SINC )
+	{
+		return;
 	}
 
-	// to keep sampling consistent, we need the modulo value for the next target buffer
-	// we subtract by once since we want to use the previous buffer's last sample, then by samplesEmitted * targetSamplesPerSourceSample
-	// because we will also be adding the emitted samples to the next buffer
-	m_TargetToSourceTargetIncr = std::fmod( m_TargetToSourceTargetIncr, static_cast<float>(targetBufferSize - 1) )
-					- 1.0f - ( static_cast<float>(samplesEmitted) * targetSamplesPerSourceSample );
+	for ( unsigned int channel = 0; channel < numChannels; channel++ )
+	{
+		m_SourceToTargetDownsamplingAAFilters[channel].call( &buffer[channel], m_SourceBufferSize, numChannels );
+	}
+}
 
-	// save last sample value in case the next buffer needs it
-	const unsigned int lastSampleIndex = targetBufferSize - 1;
-	m_WorkingTargetBufferLastSample = targetBuffer[ lastSampleIndex ];
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::filterSourceToTargetUpsampling (TType* const buffer, const unsigned int bufferSize)
+{
+	// the sinc interpolation already band limits the signal
+	if ( m_InterpolationQuality == InterpolationQuality::SINC )
+	{
+		return;
+	}
 
-	return samplesConverted;
+	for ( unsigned int channel = 0; channel < numChannels; channel++ )
+	{
+		m_SourceToTargetUpsamplingAAFilters[channel].call( &buffer[channel], bufferSize, numChannels );
+	}
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::filterSourceToTargetDownsampling (SType* const buffer)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::filterTargetToSourceDownsampling (TType* const buffer, const unsigned int bufferSize)
 {
-	m_SourceToTargetDownsamplingAAFilter.call( buffer, m_SourceBufferSize );
+	// the sinc interpolation already band limits the signal
+	if ( m_InterpolationQuality == InterpolationQuality::SINC )
+	{
+		return;
+	}
+
+	for ( unsigned int channel = 0; channel < numChannels; channel++ )
+	{
+		m_TargetToSourceDownsamplingAAFilters[channel].call( &buffer[channel], bufferSize, numChannels );
+	}
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::filterSourceToTargetUpsampling (TType* const buffer, const unsigned int bufferSize)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::filterTargetToSourceUpsampling (SType* const buffer)
 {
-	m_SourceToTargetUpsamplingAAFilter.call( buffer, bufferSize );
+	// the sinc interpolation already band limits the signal
+	if ( m_InterpolationQuality == InterpolationQuality::SINC )
+	{
+		return;
+	}
+
+	for ( unsigned int channel = 0; channel < numChannels; channel++ )
+	{
+		m_TargetToSourceUpsamplingAAFilters[channel].call( &buffer[channel], m_SourceBufferSize, numChannels );
+	}
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::filterTargetToSourceDownsampling (TType* const buffer, const unsigned int bufferSize)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::setSourceRate (const unsigned int sourceRate)
 {
-	m_TargetToSourceDownsamplingAAFilter.call( buffer, bufferSize );
+	m_SourceRate = sourceRate;
+
+	this->resetDriftControl();
+	this->calculatePhaseSteps();
+	this->calculateSincTables();
+	this->resetPhase();
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::filterTargetToSourceUpsampling (SType* const buffer)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::setTargetRate (const unsigned int targetRate)
 {
-	m_TargetToSourceUpsamplingAAFilter.call( buffer, m_SourceBufferSize );
+	m_TargetRate = targetRate;
+
+	this->resetDriftControl();
+	this->calculatePhaseSteps();
+	this->calculateSincTables();
+	this->resetPhase();
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::setSourceRate (const unsigned int sourceRate)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::setSourceBufferSize (const unsigned int bufferSize)
 {
-	m_SourceRate = sourceRate;
+	m_SourceBufferSize = bufferSize;
 
-	m_TargetBufferSize = getTargetBufferSizePerSourceBuffer();
-	m_WorkingTargetBufferLastSample = getTargetZeroPoint();
-	m_WorkingSourceBufferLastSample = getSourceZeroPoint();
-	m_SourceToTargetTargetIncr = 0.0f;
-	m_SourceToTargetSourceIncr = 0.0f;
-	m_TargetToSourceTargetIncr = -1.0f; // since we begin delayed by one target sample
+	this->resetPhase();
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::setInterpolationQuality (const InterpolationQuality quality)
+{
+	m_InterpolationQuality = quality;
+
+	this->calculateSincTables();
+	this->resetPhase();
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::resetAAFilters()
+{
+	// the sinc tables use the same window as the filters
+	this->calculateSincTables();
+
+	// sample rates are changed off the audio thread, so this is where new designs are added to the coefficient cache
+	// (the upsampling and downsampling filters running at the same rate share a design)
+	AntiAliasingFilter<SType>::cacheCoefficients( m_TargetRate / 2, m_SourceRate, m_AAFilterOrder, m_AAFilterWindow, m_AAFilterKaiserBeta,
+							m_AAFilterPhase );
+	AntiAliasingFilter<TType>::cacheCoefficients( m_SourceRate / 2, m_TargetRate, m_AAFilterOrder, m_AAFilterWindow, m_AAFilterKaiserBeta,
+							m_AAFilterPhase );
 
-	m_TargetToSourceSourceIncr = 0.0f;
-	// if downsampling from source to target, we'll be on the tail end of each "sample", so we set the source incr to be too
-	if ( ! sourceToTargetIsUpsampling() )
+	for ( auto& filter : m_SourceToTargetDownsamplingAAFilters )
 	{
-		const float sourceSamplesPerTargetSample = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
-		m_TargetToSourceSourceIncr = sourceSamplesPerTargetSample;
+		filter.changeValues(
+				// cutoff
+				m_TargetRate / 2,
+				// sample rate
+				m_SourceRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase );
+	}
+	for ( auto& filter : m_SourceToTargetUpsamplingAAFilters )
+	{
+		filter.changeValues(
+				// cutoff
+				m_SourceRate / 2,
+				// sample rate
+				m_TargetRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase );
+	}
+	for ( auto& filter : m_TargetToSourceDownsamplingAAFilters )
+	{
+		filter.changeValues(
+				// cutoff
+				m_SourceRate / 2,
+				// sample rate
+				m_TargetRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase );
+	}
+	for ( auto& filter : m_TargetToSourceUpsamplingAAFilters )
+	{
+		filter.changeValues(
+				// cutoff
+				m_TargetRate / 2,
+				// sample rate
+				m_SourceRate,
+				// filter order
+				m_AAFilterOrder,
+				// window
+				m_AAFilterWindow,
+				m_AAFilterKaiserBeta,
+				// phase
+				m_AAFilterPhase );
 	}
-
-	m_TargetToSourceEmittedSamples.clear();
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::setTargetRate (const unsigned int targetRate)
+template <typename SType, typename TType, unsigned int numChannels>
+float SampleRateConverter<SType, TType, numChannels>::getSourceToTargetLatencySamples() const
 {
-	m_TargetRate = targetRate;
+	// the output falls between the middle two interpolation points, which are half the points behind the newest input sample
+	const float targetPerSource = static_cast<float>( m_TargetRate ) / static_cast<float>( m_SourceRate );
+	const float interpolationLatency = static_cast<float>( getInterpolationPoints(m_InterpolationQuality) / 2 ) * targetPerSource;
 
-	m_TargetBufferSize = getTargetBufferSizePerSourceBuffer();
-	m_WorkingTargetBufferLastSample = getTargetZeroPoint();
-	m_WorkingSourceBufferLastSample = getSourceZeroPoint();
-	m_SourceToTargetTargetIncr = 0.0f;
-	m_SourceToTargetSourceIncr = 0.0f;
-	m_TargetToSourceTargetIncr = -1.0f; // since we begin delayed by one target sample
+	// the sinc interpolation doesn't use the filters, and its kernel is centered on the output
+	if ( m_InterpolationQuality == InterpolationQuality::SINC )
+	{
+		return interpolationLatency;
+	}
 
-	m_TargetToSourceSourceIncr = 0.0f;
-	// if downsampling from source to target, we'll be on the tail end of each "sample", so we set the source incr to be too
-	if ( ! sourceToTargetIsUpsampling() )
+	// the filter runs on the source samples when downsampling, and on the target samples when upsampling
+	if ( this->sourceToTargetIsUpsampling() )
 	{
-		const float sourceSamplesPerTargetSample = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
-		m_TargetToSourceSourceIncr = sourceSamplesPerTargetSample;
+		return interpolationLatency + m_SourceToTargetUpsamplingAAFilters[0].getLatencySamples();
 	}
 
-	m_TargetToSourceEmittedSamples.clear();
+	return interpolationLatency + ( m_SourceToTargetDownsamplingAAFilters[0].getLatencySamples() * targetPerSource );
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::setSourceBufferSize (const unsigned int bufferSize)
+template <typename SType, typename TType, unsigned int numChannels>
+float SampleRateConverter<SType, TType, numChannels>::getTargetToSourceLatencySamples() const
 {
-	m_SourceBufferSize = bufferSize;
+	// starting delayed by one target sample is cancelled out by the points starting a sample later, so this is the same as
+	// the other direction
+	const float sourcePerTarget = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
+	const float interpolationLatency = static_cast<float>( getInterpolationPoints(m_InterpolationQuality) / 2 ) * sourcePerTarget;
 
-	m_TargetBufferSize = getTargetBufferSizePerSourceBuffer();
-	m_WorkingTargetBufferLastSample = getTargetZeroPoint();
-	m_WorkingSourceBufferLastSample = getSourceZeroPoint();
-	m_SourceToTargetTargetIncr = 0.0f;
-	m_SourceToTargetSourceIncr = 0.0f;
-	m_TargetToSourceTargetIncr = -1.0f; // since we begin delayed by one target sample
+	if ( m_InterpolationQuality == InterpolationQuality::SINC )
+	{
+		return interpolationLatency;
+	}
 
-	m_TargetToSourceSourceIncr = 0.0f;
-	// if downsampling from source to target, we'll be on the tail end of each "sample", so we set the source incr to be too
-	if ( ! sourceToTargetIsUpsampling() )
+	if ( this->targetToSourceIsUpsampling() )
 	{
-		const float sourceSamplesPerTargetSample = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
-		m_TargetToSourceSourceIncr = sourceSamplesPerTargetSample;
+		return interpolationLatency + m_TargetToSourceUpsamplingAAFilters[0].getLatencySamples();
 	}
 
-	m_TargetToSourceEmittedSamples.clear();
+	return interpolationLatency + ( m_TargetToSourceDownsamplingAAFilters[0].getLatencySamples() * sourcePerTarget );
 }
 
-template <typename SType, typename TType>
-void SampleRateConverter<SType, TType>::resetAAFilters()
-{
-	m_SourceToTargetDownsamplingAAFilter.changeValues(
-			// cutoff
-			m_TargetRate / 2,
-			// sample rate
-			m_SourceRate,
-			// filter order
-			63 );
-	m_SourceToTargetUpsamplingAAFilter.changeValues(
-			// cutoff
-			m_TargetRate / 2,
-			// sample rate
-			m_TargetRate,
-			// filter order
-			63 );
-	m_TargetToSourceDownsamplingAAFilter.changeValues(
-			// cutoff
-			m_SourceRate / 2,
-			// sample rate
-			m_TargetRate,
-			// filter order
-			63 );
-	m_TargetToSourceUpsamplingAAFilter.changeValues(
-			// cutoff
-			m_SourceRate / 2,
-			// sample rate
-			m_SourceRate,
-			// filter order
-			63 );
+template <typename SType, typename TType, unsigned int numChannels>
+float SampleRateConverter<SType, TType, numChannels>::getLatencySamples() const
+{
+	const float sourcePerTarget = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
+
+	return ( this->getSourceToTargetLatencySamples() * sourcePerTarget ) + this->getTargetToSourceLatencySamples();
 }
 
-template <typename SType, typename TType>
-float SampleRateConverter<SType, TType>::getTargetBufferSizePerSourceBuffer() const
+template <typename SType, typename TType, unsigned int numChannels>
+float SampleRateConverter<SType, TType, numChannels>::getTargetBufferSizePerSourceBuffer() const
 {
 	return ( static_cast<float>(m_TargetRate) / static_cast<float>(m_SourceRate) ) * static_cast<float>(m_SourceBufferSize);
 }
 
-template<>
-constexpr float SampleRateConverter<float, float>::convertSourceToTargetType (float sourceType)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::calculatePhaseSteps()
+{
+	if ( m_Asynchronous )
+	{
+		this->calculateAsynchronousPhaseSteps();
+		return;
+	}
+
+	// with the rates divided by their greatest common divisor, each step is an exact fraction
+	const unsigned int divisor = greatestCommonDivisor( m_SourceRate, m_TargetRate );
+	const unsigned int sourceRateReduced = m_SourceRate / divisor;
+	const unsigned int targetRateReduced = m_TargetRate / divisor;
+
+	// a source to target step is sourceRate / targetRate source samples
+	m_SourceToTargetStep = sourceRateReduced / targetRateReduced;
+	m_SourceToTargetStepFrac = sourceRateReduced % targetRateReduced;
+	m_SourceToTargetFracDenominator = targetRateReduced;
+	m_SourceToTargetFracScale = 1.0f / static_cast<float>( targetRateReduced );
+
+	// a target to source step is targetRate / sourceRate target samples
+	m_TargetToSourceStep = targetRateReduced / sourceRateReduced;
+	m_TargetToSourceStepFrac = targetRateReduced % sourceRateReduced;
+	m_TargetToSourceFracDenominator = sourceRateReduced;
+	m_TargetToSourceFracScale = 1.0f / static_cast<float>( sourceRateReduced );
+}
+
+// cutoff is a fraction of the input nyquist frequency
+static void calculateSincTable (std::vector<float>& sincTable, const float cutoff, const FilterWindow window, const float kaiserBeta)
+{
+	sincTable.resize( (SRC_SINC_PHASES + 1) * SRC_SINC_TAPS );
+
+	// the output falls between the middle two taps, fraction of the way to the later one
+	const float centerTap = static_cast<float>( (SRC_SINC_TAPS / 2) - 1 );
+
+	for ( unsigned int phase = 0; phase <= SRC_SINC_PHASES; phase++ )
+	{
+		const float fraction = static_cast<float>( phase ) / static_cast<float>( SRC_SINC_PHASES );
+		float* const kernel = &sincTable[phase * SRC_SINC_TAPS];
+		float sum = 0.0f;
+
+		for ( unsigned int tap = 0; tap < SRC_SINC_TAPS; tap++ )
+		{
+			const float distance = static_cast<float>( tap ) - centerTap - fraction;
+			const float val = M_PI * cutoff * distance;
+			const float sinc = ( distance == 0.0f ) ? 1.0f : sin( val ) / val;
+			const float windowPosition = ( distance + static_cast<float>(SRC_SINC_TAPS / 2) ) / static_cast<float>( SRC_SINC_TAPS );
+
+			kernel[tap] = cutoff * sinc * calculateFilterWindow( window, kaiserBeta, windowPosition );
+			sum += kernel[tap];
+		}
+
+		// normalize each phase to unity gain, so the gain doesn't ripple with the phase
+		for ( unsigned int tap = 0; tap < SRC_SINC_TAPS; tap++ )
+		{
+			kernel[tap] /= sum;
+		}
+	}
+}
+
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::calculateSincTables()
 {
-	return sourceType;
+	if ( m_InterpolationQuality != InterpolationQuality::SINC )
+	{
+		return;
+	}
+
+	// the cutoff is at the lower of the two nyquist frequencies, relative to the rate being converted from
+	const float sourceToTargetRatio = static_cast<float>( m_TargetRate ) / static_cast<float>( m_SourceRate );
+	const float targetToSourceRatio = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
+	calculateSincTable( m_SourceToTargetSincTable, std::min(sourceToTargetRatio, 1.0f) * SRC_SINC_ROLLOFF,
+				m_AAFilterWindow, m_AAFilterKaiserBeta );
+	calculateSincTable( m_TargetToSourceSincTable, std::min(targetToSourceRatio, 1.0f) * SRC_SINC_ROLLOFF,
+				m_AAFilterWindow, m_AAFilterKaiserBeta );
 }
 
-template<>
-constexpr uint16_t SampleRateConverter<float, uint16_t>::convertSourceToTargetType (float sourceType)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::calculateAsynchronousPhaseSteps()
 {
-	return static_cast<uint16_t>( (sourceType + 1.0f) * 32767.0f );
+	// the ratio is no longer an exact fraction once it's corrected for drift, so the fractions use a fixed denominator that's fine
+	// enough for the correction to be smooth
+	const double fracDenominator = static_cast<double>( SRC_ASYNC_FRAC_DENOMINATOR );
+	const double targetRate = static_cast<double>( m_TargetRate ) * ( 1.0 + static_cast<double>(m_Drift) );
+	const double sourceToTargetStep = static_cast<double>( m_SourceRate ) / targetRate;
+	const double targetToSourceStep = targetRate / static_cast<double>( m_SourceRate );
+
+	m_SourceToTargetStep = static_cast<unsigned int>( sourceToTargetStep );
+	m_SourceToTargetStepFrac = static_cast<unsigned int>( (sourceToTargetStep - std::floor(sourceToTargetStep)) * fracDenominator );
+	m_SourceToTargetFracDenominator = SRC_ASYNC_FRAC_DENOMINATOR;
+	m_SourceToTargetFracScale = static_cast<float>( 1.0 / fracDenominator );
+
+	m_TargetToSourceStep = static_cast<unsigned int>( targetToSourceStep );
+	m_TargetToSourceStepFrac = static_cast<unsigned int>( (targetToSourceStep - std::floor(targetToSourceStep)) * fracDenominator );
+	m_TargetToSourceFracDenominator = SRC_ASYNC_FRAC_DENOMINATOR;
+	m_TargetToSourceFracScale = static_cast<float>( 1.0 / fracDenominator );
 }
 
-template<>
-constexpr int16_t SampleRateConverter<float, int16_t>::convertSourceToTargetType (float sourceType)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::setAsynchronous (const bool asynchronous)
 {
-	return static_cast<uint16_t>( sourceType * 32767.0f );
+	m_Asynchronous = asynchronous;
+
+	this->resetDriftControl();
+	this->calculatePhaseSteps();
+	this->resetPhase();
 }
 
-template<>
-constexpr float SampleRateConverter<float, float>::convertTargetToSourceType (float targetType)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::updateFillLevel (const float fillLevel)
 {
-	return targetType;
+	if ( ! m_Asynchronous )
+	{
+		return;
+	}
+
+	// this is called once per source buffer
+	const float timeStep = static_cast<float>( m_SourceBufferSize ) / static_cast<float>( m_SourceRate );
+
+	// the fill level jumps around by a block at a time, so it's smoothed well within the time the loop takes to respond
+	if ( m_FillLevelIsValid )
+	{
+		const float smoothingCoeff = 1.0f - std::exp( -timeStep / (m_DriftControlTime * SRC_FILL_LEVEL_SMOOTHING) );
+		m_SmoothedFillLevel += ( fillLevel - m_SmoothedFillLevel ) * smoothingCoeff;
+	}
+	else
+	{
+		m_SmoothedFillLevel = fillLevel;
+		m_FillLevelIsValid = true;
+	}
+
+	// a critically damped PI loop, where the fill level changes by targetRate * drift samples per second
+	const float targetRate = static_cast<float>( m_TargetRate );
+	const float proportionalGain = 2.0f / ( targetRate * m_DriftControlTime );
+	const float integralGain = 1.0f / ( targetRate * m_DriftControlTime * m_DriftControlTime );
+	const float fillLevelError = m_TargetFillLevel - m_SmoothedFillLevel;
+	const float newIntegral = m_FillLevelErrorIntegral + ( fillLevelError * timeStep );
+	const float fillLevelDrift = ( proportionalGain * fillLevelError ) + ( integralGain * newIntegral );
+
+	// the integral only accumulates while the drift isn't clamped so it doesn't wind up
+	if ( std::fabs(m_MeasuredDrift + fillLevelDrift) < m_MaxDrift )
+	{
+		m_FillLevelErrorIntegral = newIntegral;
+	}
+	m_FillLevelDrift = fillLevelDrift;
+
+	this->applyDrift();
 }
 
-template<>
-constexpr float SampleRateConverter<float, uint16_t>::convertTargetToSourceType (uint16_t targetType)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::updateMeasuredTargetRate (const float measuredTargetRate)
 {
-	return static_cast<float>( targetType - 32768 ) * ( 1.0f / 32768.0f );
+	if ( ! m_Asynchronous )
+	{
+		return;
+	}
+
+	// measurements from timestamps are noisy, so only a smoothed version is trusted
+	const float timeStep = static_cast<float>( m_SourceBufferSize ) / static_cast<float>( m_SourceRate );
+	const float smoothingCoeff = 1.0f - std::exp( -timeStep / m_DriftControlTime );
+	const float measuredDrift = ( measuredTargetRate / static_cast<float>(m_TargetRate) ) - 1.0f;
+	m_MeasuredDrift += ( measuredDrift - m_MeasuredDrift ) * smoothingCoeff;
+
+	this->applyDrift();
 }
 
-template<>
-constexpr float SampleRateConverter<float, int16_t>::convertTargetToSourceType (int16_t targetType)
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::applyDrift()
 {
-	return static_cast<float>( targetType ) * ( 1.0f / 32768.0f );
+	const float drift = m_MeasuredDrift + m_FillLevelDrift;
+	m_Drift = std::max( -m_MaxDrift, std::min(drift, m_MaxDrift) );
+
+	this->calculateAsynchronousPhaseSteps();
 }
 
-template<>
-constexpr float SampleRateConverter<float, float>::getTargetZeroPoint()
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::resetDriftControl()
 {
-	return 0.0f;
+	m_Drift = 0.0f;
+	m_MeasuredDrift = 0.0f;
+	m_FillLevelDrift = 0.0f;
+	m_FillLevelErrorIntegral = 0.0f;
+	m_SmoothedFillLevel = m_TargetFillLevel;
+	m_FillLevelIsValid = false;
 }
 
-template<>
-constexpr uint16_t SampleRateConverter<float, uint16_t>::getTargetZeroPoint()
+template <typename SType, typename TType, unsigned int numChannels>
+void SampleRateConverter<SType, TType, numChannels>::resetPhase()
 {
-	return 32767;
+	m_TargetBufferSize = getTargetBufferSizePerSourceBuffer();
+
+	m_HistoryLength = getInterpolationPoints( m_InterpolationQuality ) - 1;
+
+	// the history starts out silent, the target working buffer has room for the largest expected target buffer
+	m_SourceWorkingBuffer.assign( (m_HistoryLength + m_SourceBufferSize) * numChannels, static_cast<float>(getSourceZeroPoint()) );
+	m_TargetWorkingBuffer.assign( (m_HistoryLength + static_cast<unsigned int>(std::ceil(m_TargetBufferSize)) + 1) * numChannels,
+					static_cast<float>(getTargetZeroPoint()) );
+
+	m_SourceToTargetTargetIncr = 0;
+	m_SourceToTargetSourceIncr = 0;
+	m_SourceToTargetSourceIncrFrac = 0;
+	m_TargetToSourceTargetIncr = -1; // since we begin delayed by one target sample
+	m_TargetToSourceTargetIncrFrac = 0;
+	m_TargetToSourceSourceIncr = 0;
+
+	// fractional target buffers are a target frame longer or shorter than average, so at most a target frame's worth of source
+	// frames (plus one for rounding) is carried over, the carry has room for a few times that
+	const float sourceSamplesPerTargetSample = static_cast<float>( m_SourceRate ) / static_cast<float>( m_TargetRate );
+	const unsigned int maxCarry = static_cast<unsigned int>( std::ceil(sourceSamplesPerTargetSample) ) + 1;
+	m_TargetToSourceCarryFrames = maxCarry * 4;
+	m_TargetToSourceCarry.assign( m_TargetToSourceCarryFrames * numChannels, getSourceZeroPoint() );
+	m_TargetToSourceCarryStart = 0;
+	m_TargetToSourceCarryCount = 0;
 }
 
-template<>
-constexpr int16_t SampleRateConverter<float, int16_t>::getTargetZeroPoint()
+template <typename SType, typename TType, unsigned int numChannels>
+constexpr TType SampleRateConverter<SType, TType, numChannels>::convertSourceToTargetType (SType sourceType)
 {
-	return 0;
+	return SampleTypeConversion<SType, TType>::sourceToTarget( sourceType );
 }
 
-template<>
-constexpr float SampleRateConverter<float, float>::getSourceZeroPoint()
+template <typename SType, typename TType, unsigned int numChannels>
+constexpr SType SampleRateConverter<SType, TType, numChannels>::convertTargetToSourceType (TType targetType)
 {
-	return 0.0f;
+	return SampleTypeConversion<SType, TType>::targetToSource( targetType );
 }
 
-template<>
-constexpr float SampleRateConverter<float, uint16_t>::getSourceZeroPoint()
+template <typename SType, typename TType, unsigned int numChannels>
+constexpr TType SampleRateConverter<SType, TType, numChannels>::getTargetZeroPoint()
 {
-	return 0.0f;
+	return SampleTypeConversion<SType, TType>::targetZeroPoint();
 }
 
-template<>
-constexpr float SampleRateConverter<float, int16_t>::getSourceZeroPoint()
+template <typename SType, typename TType, unsigned int numChannels>
+constexpr SType SampleRateConverter<SType, TType, numChannels>::getSourceZeroPoint()
 {
-	return 0.0f;
+	return SampleTypeConversion<SType, TType>::sourceZeroPoint();
 }
 
 // avoid linker errors
-template class SampleRateConverter<float, float>;
-template class SampleRateConverter<float, uint16_t>;
-template class SampleRateConverter<float, int16_t>;
+template class SampleRateConverter<float, float, 1>;
+template class SampleRateConverter<float, uint16_t, 1>;
+template class SampleRateConverter<float, int16_t, 1>;
+template class SampleRateConverter<float, float, 2>;
+template class SampleRateConverter<float, uint16_t, 2>;
+template class SampleRateConverter<float, int16_t, 2>;
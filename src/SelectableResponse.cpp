@@ -0,0 +1,12 @@
+#include "SelectableResponse.hpp"
+
+SelectableResponse::SelectableResponse (const ResponseType type, const float slope) :
+	m_ResponseType( type ),
+	m_LinearResponse(),
+	m_ExponentialResponse( slope )
+{
+}
+
+SelectableResponse::~SelectableResponse()
+{
+}
@@ -51,9 +51,9 @@ void SimpleDelay<T>::setDelayLength (unsigned int delayLength)
 }
 
 template <typename T>
-void SimpleDelay<T>::call (T* writeBuffer)
+void SimpleDelay<T>::process (T* writeBuffer, unsigned int numSamples)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		writeBuffer[sample] = this->processSampleHelper( writeBuffer[sample] );
 	}
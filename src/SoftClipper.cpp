@@ -4,9 +4,9 @@
 
 
 template <typename T, bool use12Bit>
-void SoftClipper<T, use12Bit>::call (T* writeBuffer)
+void SoftClipper<T, use12Bit>::process (T* writeBuffer, unsigned int numSamples)
 {
-	for ( unsigned int sample = 0; sample < ABUFFER_SIZE; sample++ )
+	for ( unsigned int sample = 0; sample < numSamples; sample++ )
 	{
 		writeBuffer[sample] = this->processSample( writeBuffer[sample] );
 	}
@@ -0,0 +1,49 @@
+#include "Wavetable.hpp"
+
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+#include <map>
+#include <mutex>
+
+// sine tables are only ever added, since oscillators may be holding on to them
+static std::map<unsigned int, std::shared_ptr<const Wavetable>> s_SineTables;
+static std::mutex s_SineTablesMutex;
+
+Wavetable::Wavetable (const float* const cycle, const unsigned int size) :
+	m_Table( cycle, cycle + size ),
+	m_Mask( size - 1 ),
+	m_SizeFloat( static_cast<float>(size) )
+{
+	m_Table.push_back( cycle[0] );
+}
+
+std::shared_ptr<const Wavetable> Wavetable::getSineTable (const unsigned int size)
+{
+	std::lock_guard<std::mutex> lock( s_SineTablesMutex );
+
+	auto sineTable = s_SineTables.find( size );
+	if ( sineTable != s_SineTables.end() )
+	{
+		return sineTable->second;
+	}
+
+	std::vector<float> cycle( size );
+	for ( unsigned int sample = 0; sample < size; sample++ )
+	{
+		cycle[sample] = static_cast<float>( sin(2.0 * M_PI * static_cast<double>(sample) / static_cast<double>(size)) );
+	}
+
+	std::shared_ptr<const Wavetable> newSineTable = std::make_shared<const Wavetable>( cycle.data(), size );
+	s_SineTables.emplace( size, newSineTable );
+
+	return newSineTable;
+}
+
+float Wavetable::getSineTableMaxError (const unsigned int size)
+{
+	// linear interpolation is off by at most (step^2 / 8) * the largest second derivative, which is 1 for a sine
+	const float step = 2.0f * M_PI / static_cast<float>( size );
+
+	return ( (step * step) / 8.0f ) + SINE_TABLE_ROUNDING_ERROR;
+}